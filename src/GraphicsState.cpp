@@ -1,4 +1,5 @@
 #include "GraphicsState.hpp"
+#include <algorithm>
 
 void GraphicsState::SetLineCapStyle(LineCapStyle lineCapStyle)
 {
@@ -30,6 +31,29 @@ void GraphicsState::SetTransform(const CTM& transform)
   m_transform = m_transform * transform;
 }
 
+void GraphicsState::ResetTransform()
+{
+  m_transform = CTM::Identity();
+}
+
+void GraphicsState::IntersectClip(const Rectangle& clip)
+{
+  if (!m_clip)
+  {
+    m_clip = clip;
+    return;
+  }
+  m_clip->min = { std::max(m_clip->min.x, clip.min.x), std::max(m_clip->min.y, clip.min.y) };
+  m_clip->max = { std::min(m_clip->max.x, clip.max.x), std::min(m_clip->max.y, clip.max.y) };
+  // An empty intersection is kept as an empty rectangle, so equal clips compare equal
+  m_clip->max = { std::max(m_clip->min.x, m_clip->max.x), std::max(m_clip->min.y, m_clip->max.y) };
+}
+
+void GraphicsState::ResetClip()
+{
+  m_clip.reset();
+}
+
 LineCapStyle GraphicsState::GetLineCapStyle() const
 {
   return m_lineCapStyle;
@@ -60,8 +84,28 @@ const CTM& GraphicsState::GetTransform() const
   return m_transform;
 }
 
+const std::optional<Rectangle>& GraphicsState::GetClip() const
+{
+  return m_clip;
+}
+
 Vector2 GraphicsState::Transform(const Vector2& point) const
 {
   Vector3 result{ m_transform * Vector3{ point.x, point.y, 1.f } };
   return { result.x / result.z, result.y / result.z };
 }
+
+Rectangle GraphicsState::Transform(const Rectangle& rectangle) const
+{
+  const Vector2 corners[]{ Transform(rectangle.min),
+                           Transform(Vector2{ rectangle.max.x, rectangle.min.y }),
+                           Transform(rectangle.max),
+                           Transform(Vector2{ rectangle.min.x, rectangle.max.y }) };
+  Rectangle bounds{ corners[0], corners[0] };
+  for (const Vector2& corner : corners)
+  {
+    bounds.min = { std::min(bounds.min.x, corner.x), std::min(bounds.min.y, corner.y) };
+    bounds.max = { std::max(bounds.max.x, corner.x), std::max(bounds.max.y, corner.y) };
+  }
+  return bounds;
+}
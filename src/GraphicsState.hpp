@@ -1,7 +1,9 @@
 #pragma once
 
 #include "math/Matrix.hpp"
+#include "math/Rectangle.hpp"
 #include "math/Vector.hpp"
+#include <optional>
 
 enum class LineCapStyle
 {
@@ -21,20 +23,29 @@ using CTM = Matrix<float, 3, 3>;
 
 class GraphicsState
 {
-  LineCapStyle m_lineCapStyle;
-  LineJoinStyle m_lineJoinStyle;
-  Vector3 m_strokeColor;
-  Vector3 m_fillColor;
-  float m_lineWidth;
+  LineCapStyle m_lineCapStyle{ LineCapStyle::Butt };
+  LineJoinStyle m_lineJoinStyle{ LineJoinStyle::Miter };
+  Vector3 m_strokeColor{ 0.0f };
+  Vector3 m_fillColor{ 0.0f };
+  float m_lineWidth{ 0.0f };
   CTM m_transform{ CTM::Identity() };
+  // In the space of the page, the bounding box of the intersected clipping paths
+  std::optional<Rectangle> m_clip;
 
 public:
+  bool operator==(const GraphicsState& other) const = default;
+
   void SetLineCapStyle(LineCapStyle lineCapStyle);
   void SetLineJoinStyle(LineJoinStyle lineJoinStyle);
   void SetStrokeColor(const Vector3& strokeColor);
   void SetFillColor(const Vector3& fillColor);
   void SetLineWidth(float lineWidth);
+  // Appends the transform to the current one
   void SetTransform(const CTM& transform);
+  void ResetTransform();
+  // Intersects the clip with the bounding box of a clipping path in the space of the page
+  void IntersectClip(const Rectangle& clip);
+  void ResetClip();
 
   LineCapStyle GetLineCapStyle() const;
   LineJoinStyle GetLineJoinStyle() const;
@@ -42,6 +53,9 @@ public:
   const Vector3& GetFillColor() const;
   float GetLineWidth() const;
   const CTM& GetTransform() const;
+  const std::optional<Rectangle>& GetClip() const;
 
   Vector2 Transform(const Vector2& point) const;
+  // Bounding box of the transformed corners
+  Rectangle Transform(const Rectangle& rectangle) const;
 };
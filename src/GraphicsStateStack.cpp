@@ -0,0 +1,21 @@
+#include "GraphicsStateStack.hpp"
+
+GraphicsStateStack::GraphicsStateStack(const GraphicsState& graphicsState)
+  : m_states{ graphicsState }
+  , m_levels{ 0 }
+{
+}
+
+void GraphicsStateStack::Restore()
+{
+  const size_t stateIndex{ m_levels.back() };
+  m_levels.pop_back();
+  if (m_levels.empty())
+  {
+    *this = GraphicsStateStack{};
+    return;
+  }
+  // A state which was copied for the level is the last one, the levels below only use the states before it
+  if (m_levels.back() != stateIndex)
+    m_states.pop_back();
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "GraphicsState.hpp"
+#include <cstddef>
+#include <vector>
+
+// The graphics states saved by q. Saving a state is copy-on-write: q only pushes the index of the current state, which
+// is copied when it is changed on the new level. Pages which save and restore the state around every path only copy it
+// when they change it.
+class GraphicsStateStack
+{
+  std::vector<GraphicsState> m_states; // Distinct states of the levels, the last one is the current state
+  std::vector<size_t> m_levels;        // Index in m_states for each level, the last one is the current level
+
+public:
+  explicit GraphicsStateStack(const GraphicsState& graphicsState = {});
+
+  void Save() { m_levels.push_back(m_levels.back()); }
+  // An unbalanced restore starts again with the default state
+  void Restore();
+
+  const GraphicsState& GetCurrent() const { return m_states.back(); }
+  // The current state for changing it, copied first if it is shared with the level below
+  GraphicsState& ModifyCurrent()
+  {
+    if (m_levels.size() > 1 && m_levels[m_levels.size() - 2] == m_levels.back())
+    {
+      m_states.push_back(m_states.back());
+      m_levels.back() = m_states.size() - 1;
+    }
+    return m_states.back();
+  }
+};
@@ -0,0 +1,40 @@
+#include "GraphicsStateTable.hpp"
+#include <bit>
+#include <initializer_list>
+
+size_t GraphicsStateTable::Hash::operator()(const GraphicsState& graphicsState) const
+{
+  const Vector3& strokeColor{ graphicsState.GetStrokeColor() };
+  const Vector3& fillColor{ graphicsState.GetFillColor() };
+  size_t hash{ static_cast<size_t>(graphicsState.GetLineCapStyle()) * 3 +
+               static_cast<size_t>(graphicsState.GetLineJoinStyle()) };
+  auto Combine{ [&](float value)
+  {
+    // 0 and -0 are equal, so they need the same hash
+    hash = hash * 0x100000001B3ull ^ std::bit_cast<uint32_t>(value == 0.f ? 0.f : value);
+  } };
+  for (float value : { strokeColor.x, strokeColor.y, strokeColor.z, fillColor.x, fillColor.y, fillColor.z })
+    Combine(value);
+  Combine(graphicsState.GetLineWidth());
+  const float* transform{ graphicsState.GetTransform().Data() };
+  for (int valueIndex{ 0 }; valueIndex < 9; ++valueIndex)
+    Combine(transform[valueIndex]);
+  if (const auto& clip{ graphicsState.GetClip() })
+  {
+    for (float value : { clip->min.x, clip->min.y, clip->max.x, clip->max.y })
+      Combine(value);
+  }
+  return hash;
+}
+
+GraphicsStateTable::Index GraphicsStateTable::Intern(const GraphicsState& graphicsState)
+{
+  if (m_lastIndex < m_states.size() && m_states[m_lastIndex] == graphicsState)
+    return m_lastIndex;
+
+  const auto [indexIt, inserted]{ m_indices.try_emplace(graphicsState, static_cast<Index>(m_states.size())) };
+  if (inserted)
+    m_states.push_back(graphicsState);
+  m_lastIndex = indexIt->second;
+  return m_lastIndex;
+}
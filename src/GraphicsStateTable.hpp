@@ -0,0 +1,32 @@
+#pragma once
+
+#include "GraphicsState.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// The distinct graphics states of a page. Paths refer to their state by its index, so consecutive paths which are
+// painted with the same state have the same index and can be batched.
+class GraphicsStateTable
+{
+public:
+  using Index = uint32_t;
+
+private:
+  struct Hash
+  {
+    size_t operator()(const GraphicsState& graphicsState) const;
+  };
+
+  std::vector<GraphicsState> m_states;
+  std::unordered_map<GraphicsState, Index, Hash> m_indices;
+  Index m_lastIndex{ 0 }; // Of the last interned state, pages usually paint many paths in a row with the same state
+
+public:
+  // Index of the state, which is added if the table does not have it yet
+  Index Intern(const GraphicsState& graphicsState);
+
+  const GraphicsState& operator[](Index index) const { return m_states[index]; }
+  size_t GetSize() const { return m_states.size(); }
+};
@@ -0,0 +1,136 @@
+#include "MappedFile.hpp"
+#include <utility>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+  Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+  *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+  if (this != &other)
+  {
+    Close();
+    m_data = std::exchange(other.m_data, nullptr);
+    m_size = std::exchange(other.m_size, 0);
+#ifdef _WIN32
+    m_fileHandle = std::exchange(other.m_fileHandle, nullptr);
+    m_mappingHandle = std::exchange(other.m_mappingHandle, nullptr);
+#endif
+  }
+  return *this;
+}
+
+#ifdef _WIN32
+bool MappedFile::Open(const std::filesystem::path& path)
+{
+  Close();
+
+  HANDLE file{ CreateFileW(
+    path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+  if (file == INVALID_HANDLE_VALUE)
+    return false;
+
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+  {
+    CloseHandle(file);
+    return false;
+  }
+
+  HANDLE mapping{ CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr) };
+  if (mapping == nullptr)
+  {
+    CloseHandle(file);
+    return false;
+  }
+
+  void* data{ MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) };
+  if (data == nullptr)
+  {
+    CloseHandle(mapping);
+    CloseHandle(file);
+    return false;
+  }
+
+  m_fileHandle = file;
+  m_mappingHandle = mapping;
+  m_data = static_cast<const char*>(data);
+  m_size = static_cast<size_t>(fileSize.QuadPart);
+  return true;
+}
+
+void MappedFile::Close()
+{
+  if (m_data != nullptr)
+    UnmapViewOfFile(m_data);
+  if (m_mappingHandle != nullptr)
+    CloseHandle(m_mappingHandle);
+  if (m_fileHandle != nullptr)
+    CloseHandle(m_fileHandle);
+  m_data = nullptr;
+  m_size = 0;
+  m_mappingHandle = nullptr;
+  m_fileHandle = nullptr;
+}
+#else
+bool MappedFile::Open(const std::filesystem::path& path)
+{
+  Close();
+
+  int file{ open(path.c_str(), O_RDONLY) };
+  if (file == -1)
+    return false;
+
+  struct stat fileStatus;
+  if (fstat(file, &fileStatus) != 0 || !S_ISREG(fileStatus.st_mode) || fileStatus.st_size == 0)
+  {
+    close(file);
+    return false;
+  }
+
+  size_t size{ static_cast<size_t>(fileStatus.st_size) };
+  void* data{ mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0) };
+  close(file); // The mapping stays valid after the file descriptor is closed
+  if (data == MAP_FAILED)
+    return false;
+
+  m_data = static_cast<const char*>(data);
+  m_size = size;
+  return true;
+}
+
+void MappedFile::Close()
+{
+  if (m_data != nullptr)
+    munmap(const_cast<char*>(m_data), m_size);
+  m_data = nullptr;
+  m_size = 0;
+}
+#endif
+
+bool MappedFile::IsOpen() const
+{
+  return m_data != nullptr;
+}
+
+std::string_view MappedFile::GetData() const
+{
+  return { m_data, m_size };
+}
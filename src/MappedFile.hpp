@@ -0,0 +1,27 @@
+#pragma once
+
+#include <filesystem>
+#include <string_view>
+
+class MappedFile
+{
+  const char* m_data{ nullptr };
+  size_t m_size{ 0 };
+#ifdef _WIN32
+  void* m_fileHandle{ nullptr };
+  void* m_mappingHandle{ nullptr };
+#endif
+
+public:
+  MappedFile() = default;
+  ~MappedFile();
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  MappedFile(MappedFile&& other) noexcept;
+  MappedFile& operator=(MappedFile&& other) noexcept;
+
+  bool Open(const std::filesystem::path& path);
+  void Close();
+  bool IsOpen() const;
+  std::string_view GetData() const;
+};
@@ -32,4 +32,9 @@ void Buffer::SetData(std::ptrdiff_t dataLength, const void* data)
 {
   glBufferData(GL_ARRAY_BUFFER, dataLength, data, GL_STATIC_DRAW);
 }
+
+void Buffer::SetSubData(std::ptrdiff_t offset, std::ptrdiff_t dataLength, const void* data)
+{
+  glBufferSubData(GL_ARRAY_BUFFER, offset, dataLength, data);
+}
 } // namespace gl
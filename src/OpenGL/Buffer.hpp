@@ -17,5 +17,6 @@ public:
   void Bind() const;
   void Unbind() const;
   void SetData(std::ptrdiff_t dataLength, const void* data);
+  void SetSubData(std::ptrdiff_t offset, std::ptrdiff_t dataLength, const void* data);
 };
 } // namespace gl
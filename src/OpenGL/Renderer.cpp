@@ -1,9 +1,10 @@
 #include "Renderer.hpp"
-#include "OpenGL/Buffer.hpp"
 #include "OpenGL/Error.hpp"
 #include "Window.hpp"
 #include <GL/glew.h>
 #include <iostream>
+#include <unordered_map>
+#include <utility>
 
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include <stb_image_write.h>
@@ -13,10 +14,12 @@ namespace
 const char* scalingVertexShader{ R"""(#version 330 core
 layout(location = 0) in vec2 position2d;
 layout(location = 1) in vec3 color;
+// Rows of the transform of a form instance, the identity for the triangles of the pages
+layout(location = 2) in mat3 instanceTransform;
 out vec3 colorPS;
 uniform mat3 inputTransform;
 void main() {
-  vec3 transformed = inputTransform * vec3(position2d, 1.f);
+  vec3 transformed = inputTransform * (vec3(position2d, 1.f) * instanceTransform);
   gl_Position = vec4(transformed.xy / transformed.z, 0.f, 1.f);
   colorPS = color;
 }
@@ -96,15 +99,18 @@ Renderer::~Renderer()
   CheckError();
 }
 
-void Renderer::SetTriangleBuffer(std::vector<Triangle>&& triangles)
+void Renderer::SetPageTriangles(int page, PageTriangles&& triangles)
 {
-  m_triangles = triangles;
-  m_ready = true;
+  std::lock_guard lock{ m_trianglesMutex };
+  m_pageTriangles[page] = std::move(triangles);
+  m_trianglesChanged = true;
 }
 
-void Renderer::AddTriangles(const std::vector<Triangle>& triangles)
+void Renderer::ClearPages()
 {
-  m_triangles.insert(m_triangles.end(), triangles.begin(), triangles.end());
+  std::lock_guard lock{ m_trianglesMutex };
+  m_pageTriangles.clear();
+  m_trianglesChanged = true;
 }
 
 void Renderer::Finish()
@@ -120,8 +126,8 @@ void Renderer::SetWindowSize(const Vector2i& windowSize)
 
 void Renderer::SetDrawArea(const Rectangle& drawArea)
 {
-  m_drawArea = drawArea;
-  m_drawAreaChanged = true;
+  std::lock_guard lock{ m_trianglesMutex };
+  m_newDrawArea = drawArea;
 }
 
 void Renderer::Draw()
@@ -135,9 +141,7 @@ void Renderer::Draw()
 
     m_vao.Bind();
 
-    Buffer buffer;
-    buffer.Bind();
-    buffer.SetData(m_triangles.size() * sizeof(m_triangles[0]), m_triangles.data());
+    m_vertexBuffer.Bind();
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(
       0, 2, GL_FLOAT, GL_FALSE, sizeof(Triangle::Vertex), (void*)offsetof(Triangle::Vertex, position));
@@ -146,10 +150,29 @@ void Renderer::Draw()
 
     m_vao.Unbind();
 
+    // The pointers to the transforms are set for each draw call, OpenGL 3.3 cannot start at another instance
+    m_formVao.Bind();
+
+    m_formVertexBuffer.Bind();
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(
+      0, 2, GL_FLOAT, GL_FALSE, sizeof(Triangle::Vertex), (void*)offsetof(Triangle::Vertex, position));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Triangle::Vertex), (void*)offsetof(Triangle::Vertex, color));
+    for (unsigned row{ 0 }; row < 3; row++)
+    {
+      glEnableVertexAttribArray(2 + row);
+      glVertexAttribDivisor(2 + row, 1);
+    }
+
+    m_formVao.Unbind();
+
     glClearColor(0.9f, 0.9f, 0.9f, 1.f);
     CheckError();
   }
 
+  UploadTriangles();
+
   if (m_windowSizeChanged)
   {
     RecreateFramebuffer();
@@ -177,8 +200,34 @@ void Renderer::Draw()
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
   m_program.Use();
 
-  m_vao.Bind();
-  glDrawArrays(GL_TRIANGLES, 0, static_cast<int>(m_triangles.size() * 3));
+  for (const DrawCall& drawCall : m_drawCalls)
+  {
+    if (drawCall.m_instanceCount == 0)
+    {
+      m_vao.Bind();
+      // The current values of attributes without an array are not part of the vertex array object
+      glVertexAttrib3f(2, 1.f, 0.f, 0.f);
+      glVertexAttrib3f(3, 0.f, 1.f, 0.f);
+      glVertexAttrib3f(4, 0.f, 0.f, 1.f);
+      glDrawArrays(GL_TRIANGLES, drawCall.m_firstVertex, drawCall.m_vertexCount);
+    }
+    else
+    {
+      m_formVao.Bind();
+      m_instanceBuffer.Bind();
+      // Matrix3 is row-major, each row is a column of the mat3 attribute and the shader multiplies from the left
+      for (unsigned row{ 0 }; row < 3; row++)
+      {
+        glVertexAttribPointer(2 + row,
+                              3,
+                              GL_FLOAT,
+                              GL_FALSE,
+                              sizeof(Matrix3),
+                              (void*)(drawCall.m_instanceOffset + row * 3 * sizeof(float)));
+      }
+      glDrawArraysInstanced(GL_TRIANGLES, drawCall.m_firstVertex, drawCall.m_vertexCount, drawCall.m_instanceCount);
+    }
+  }
   m_vao.Unbind();
 
   glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
@@ -189,6 +238,98 @@ void Renderer::Draw()
   CheckError();
 }
 
+void Renderer::UploadTriangles()
+{
+  std::lock_guard lock{ m_trianglesMutex };
+  if (m_newDrawArea)
+  {
+    m_drawArea = *std::exchange(m_newDrawArea, std::nullopt);
+    m_drawAreaChanged = true;
+  }
+  if (!m_trianglesChanged)
+    return;
+  m_trianglesChanged = false;
+
+  // Forms shared by pages are uploaded once
+  size_t triangleCount{ 0 };
+  size_t formTriangleCount{ 0 };
+  size_t transformCount{ 0 };
+  std::unordered_map<const std::vector<Triangle>*, int> formFirstVertices;
+  for (const auto& [page, pageTriangles] : m_pageTriangles)
+  {
+    triangleCount += pageTriangles.m_triangles.size();
+    for (const auto& instances : pageTriangles.m_instances)
+    {
+      transformCount += instances.m_transforms.size();
+      if (formFirstVertices.emplace(instances.m_triangles.get(), static_cast<int>(formTriangleCount * 3)).second)
+        formTriangleCount += instances.m_triangles->size();
+    }
+  }
+
+  m_vertexBuffer.Bind();
+  m_vertexBuffer.SetData(static_cast<std::ptrdiff_t>(triangleCount * sizeof(Triangle)), nullptr);
+  std::ptrdiff_t offset{ 0 };
+  for (const auto& [page, pageTriangles] : m_pageTriangles)
+  {
+    std::ptrdiff_t size{ static_cast<std::ptrdiff_t>(pageTriangles.m_triangles.size() * sizeof(Triangle)) };
+    m_vertexBuffer.SetSubData(offset, size, pageTriangles.m_triangles.data());
+    offset += size;
+  }
+  m_vertexBuffer.Unbind();
+
+  m_formVertexBuffer.Bind();
+  m_formVertexBuffer.SetData(static_cast<std::ptrdiff_t>(formTriangleCount * sizeof(Triangle)), nullptr);
+  for (const auto& [triangles, firstVertex] : formFirstVertices)
+  {
+    m_formVertexBuffer.SetSubData(static_cast<std::ptrdiff_t>(firstVertex / 3 * sizeof(Triangle)),
+                                  static_cast<std::ptrdiff_t>(triangles->size() * sizeof(Triangle)),
+                                  triangles->data());
+  }
+  m_formVertexBuffer.Unbind();
+
+  // The triangles of the pages are split where instances are painted between them, so the painting order is kept
+  m_drawCalls.clear();
+  int pageFirstVertex{ 0 };
+  auto AddTriangles{ [&](size_t firstTriangle, size_t endTriangle)
+  {
+    const int firstVertex{ pageFirstVertex + static_cast<int>(firstTriangle * 3) };
+    const int vertexCount{ static_cast<int>((endTriangle - firstTriangle) * 3) };
+    if (vertexCount == 0)
+      return;
+    if (!m_drawCalls.empty() && m_drawCalls.back().m_instanceCount == 0 &&
+        m_drawCalls.back().m_firstVertex + m_drawCalls.back().m_vertexCount == firstVertex)
+      m_drawCalls.back().m_vertexCount += vertexCount;
+    else
+      m_drawCalls.push_back({ firstVertex, vertexCount, 0, 0 });
+  } };
+
+  m_instanceBuffer.Bind();
+  m_instanceBuffer.SetData(static_cast<std::ptrdiff_t>(transformCount * sizeof(Matrix3)), nullptr);
+  std::ptrdiff_t instanceOffset{ 0 };
+  for (const auto& [page, pageTriangles] : m_pageTriangles)
+  {
+    size_t triangleOffset{ 0 };
+    for (const auto& instances : pageTriangles.m_instances)
+    {
+      AddTriangles(triangleOffset, instances.m_triangleOffset);
+      triangleOffset = instances.m_triangleOffset;
+
+      std::ptrdiff_t size{ static_cast<std::ptrdiff_t>(instances.m_transforms.size() * sizeof(Matrix3)) };
+      m_instanceBuffer.SetSubData(instanceOffset, size, instances.m_transforms.data());
+      m_drawCalls.push_back({ formFirstVertices.at(instances.m_triangles.get()),
+                              static_cast<int>(instances.m_triangles->size() * 3),
+                              static_cast<int>(instances.m_transforms.size()),
+                              instanceOffset });
+      instanceOffset += size;
+    }
+    AddTriangles(triangleOffset, pageTriangles.m_triangles.size());
+    pageFirstVertex += static_cast<int>(pageTriangles.m_triangles.size() * 3);
+  }
+  m_instanceBuffer.Unbind();
+
+  CheckError();
+}
+
 Vector2 Renderer::GetNormalizedMousePosition(const Vector2i& mousePosition)
 {
   return Vector2{ m_windowSize.x - mousePosition.x, mousePosition.y }.cwiseQuotient(Vector2{ m_windowSize });
@@ -1,11 +1,18 @@
 #pragma once
 
+#include "OpenGL/Buffer.hpp"
 #include "OpenGL/GlewInitializer.hpp"
 #include "OpenGL/Program.hpp"
 #include "OpenGL/VertexArray.hpp"
+#include "PageTriangles.hpp"
 #include "math/Rectangle.hpp"
 #include "math/Triangle.hpp"
+#include <atomic>
+#include <cstddef>
 #include <filesystem>
+#include <map>
+#include <mutex>
+#include <optional>
 #include <vector>
 
 class Window;
@@ -14,7 +21,7 @@ namespace gl
 {
 class Renderer
 {
-  bool m_ready{ false };
+  std::atomic<bool> m_ready{ false };
   bool m_initialDraw{ true };
 
   Vector2 m_dpi;
@@ -33,25 +40,47 @@ class Renderer
   bool m_leftButtonPressed{ false };
   Vector2 m_lastMousePosition;
 
-  std::vector<Triangle> m_triangles;
+  // Written by the loading thread, uploaded by the render thread
+  std::mutex m_trianglesMutex;
+  std::map<int, PageTriangles> m_pageTriangles;
+  bool m_trianglesChanged{ false };
+  std::optional<Rectangle> m_newDrawArea;
+
+  // Ranges of the vertex buffers in painting order
+  struct DrawCall
+  {
+    int m_firstVertex{ 0 };
+    int m_vertexCount{ 0 };
+    int m_instanceCount{ 0 }; // Zero for the triangles of the pages, which are not instanced
+    std::ptrdiff_t m_instanceOffset{ 0 };
+  };
+  std::vector<DrawCall> m_drawCalls;
 
   unsigned m_fbo{ 0 };
   int m_maxSampleCount{ -1 };
   GlewInitializer m_glewInitializer;
   VertexArray m_vao;
+  Buffer m_vertexBuffer;
+  // The triangles of each form once, drawn with the transforms of its placements
+  VertexArray m_formVao;
+  Buffer m_formVertexBuffer;
+  Buffer m_instanceBuffer;
   Program m_program;
 
   Vector2 GetNormalizedMousePosition(const Vector2i& mousePosition);
   Matrix3 GetViewportTransform() const;
   void RecreateFramebuffer();
+  void UploadTriangles();
 
 public:
   Renderer(Window& window, const Vector2& dpi);
   ~Renderer();
-  void SetTriangleBuffer(std::vector<Triangle>&& triangles);
-  void AddTriangles(const std::vector<Triangle>& triangles);
+  // Replaces the triangles of a single page, the other pages keep their triangles
+  void SetPageTriangles(int page, PageTriangles&& triangles);
+  void ClearPages();
   void Finish();
   void SetWindowSize(const Vector2i& windowSize);
+  // Can be called while the render thread draws, the area is applied before the next frame
   void SetDrawArea(const Rectangle& drawArea);
   void Draw();
 
@@ -0,0 +1,49 @@
+#include "PDFArena.hpp"
+#include <algorithm>
+#include <cstdint>
+
+void* PDFArena::Allocate(size_t size, size_t alignment)
+{
+  // Most objects are small, larger allocations like long strings get a block of their own
+  constexpr size_t BLOCK_SIZE{ 64 << 10 };
+
+  std::lock_guard lock{ m_mutex };
+  size_t padding{ (alignment - reinterpret_cast<uintptr_t>(m_position) % alignment) % alignment };
+  if (m_position == nullptr || padding + size > m_remaining)
+  {
+    size_t blockSize{ std::max(BLOCK_SIZE, size + alignment) };
+    m_blocks.push_back(std::make_unique_for_overwrite<std::byte[]>(blockSize));
+    if (size + alignment > BLOCK_SIZE)
+    {
+      std::byte* block{ m_blocks.back().get() };
+      return block + (alignment - reinterpret_cast<uintptr_t>(block) % alignment) % alignment;
+    }
+    m_position = m_blocks.back().get();
+    m_remaining = blockSize;
+    padding = (alignment - reinterpret_cast<uintptr_t>(m_position) % alignment) % alignment;
+  }
+
+  std::byte* allocation{ m_position + padding };
+  m_position += padding + size;
+  m_remaining -= padding + size;
+  return allocation;
+}
+
+void PDFArena::Adopt(PDFArena& other)
+{
+  std::scoped_lock lock{ m_mutex, other.m_mutex };
+  m_blocks.insert(m_blocks.end(),
+                  std::make_move_iterator(other.m_blocks.begin()),
+                  std::make_move_iterator(other.m_blocks.end()));
+  other.m_blocks.clear();
+  other.m_position = nullptr;
+  other.m_remaining = 0;
+}
+
+void PDFArena::Clear()
+{
+  std::lock_guard lock{ m_mutex };
+  m_blocks.clear();
+  m_position = nullptr;
+  m_remaining = 0;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+// Monotonic allocator for the arrays, dictionaries and strings of the objects of a document. Memory is only released
+// all at once by Clear, so the objects can be small trivially copyable handles into the arena.
+class PDFArena
+{
+  std::mutex m_mutex;
+  std::vector<std::unique_ptr<std::byte[]>> m_blocks;
+  std::byte* m_position{ nullptr };
+  size_t m_remaining{ 0 };
+
+public:
+  PDFArena() = default;
+  PDFArena(const PDFArena&) = delete;
+  PDFArena& operator=(const PDFArena&) = delete;
+
+  // Thread-safe, the returned memory is valid until Clear is called
+  void* Allocate(size_t size, size_t alignment);
+  void Clear();
+  // Takes over the blocks of the other arena, memory allocated from it stays valid until this arena is cleared
+  void Adopt(PDFArena& other);
+
+  template <typename T>
+  std::span<const std::remove_const_t<T>> Copy(std::span<T> values)
+  {
+    using Value = std::remove_const_t<T>;
+    static_assert(std::is_trivially_copyable_v<Value> && std::is_trivially_destructible_v<Value>);
+    if (values.empty())
+      return {};
+    Value* destination{ static_cast<Value*>(Allocate(values.size_bytes(), alignof(Value))) };
+    std::memcpy(destination, values.data(), values.size_bytes());
+    return { destination, values.size() };
+  }
+};
@@ -0,0 +1,326 @@
+#include "PDFContentLexer.hpp"
+#include "PDFParser.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PDF_CONTENT_LEXER_SSE2
+#endif
+
+namespace
+{
+enum class CharacterClass : uint8_t
+{
+  Regular,
+  Whitespace,
+  Delimiter,
+};
+
+constexpr std::array<CharacterClass, 256> CHARACTER_CLASSES{ []()
+{
+  std::array<CharacterClass, 256> characterClasses{};
+  for (size_t c{ 0 }; c < characterClasses.size(); ++c)
+  {
+    if (PDFParser::IsWhitespace(static_cast<char>(c)))
+      characterClasses[c] = CharacterClass::Whitespace;
+    else if (PDFParser::IsDelimiter(static_cast<char>(c)))
+      characterClasses[c] = CharacterClass::Delimiter;
+  }
+  return characterClasses;
+}() };
+
+CharacterClass GetCharacterClass(char c)
+{
+  return CHARACTER_CLASSES[static_cast<uint8_t>(c)];
+}
+
+// Plain decimals like "-12.34" with at most 8 characters after the sign are most of the tokens of a content stream.
+// They are converted with SWAR arithmetic on a single 64-bit word, which avoids the mispredicted branches of a loop over
+// the characters. Tokens whose data ends less than 8 bytes before the end of the stream, other forms and longer numbers
+// use PDFParser::ParseDecimal.
+bool ParseNumber(std::string_view token, size_t readableSize, PDFObject::Decimal& number)
+{
+  constexpr uint64_t ONES{ 0x0101010101010101 };
+  constexpr std::array<double, 8> POWERS_OF_TEN{ 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7 };
+
+  if constexpr (std::endian::native != std::endian::little)
+    return PDFParser::ParseDecimal(token, number);
+
+  // Single digits are the operands of most graphics state operators
+  if (token.size() == 1 && PDFParser::IsDigit(token.front()))
+  {
+    number = static_cast<PDFObject::Decimal>(token.front() - '0');
+    return true;
+  }
+
+  std::string_view digits{ token };
+  const bool negative{ digits.front() == '-' };
+  if (negative || digits.front() == '+')
+    digits.remove_prefix(1);
+  const size_t size{ digits.size() };
+  if (size == 0 || size > 8 || readableSize - (token.size() - size) < 8 || digits == ".")
+    return PDFParser::ParseDecimal(token, number);
+
+  // Little-endian word with the first character in byte 8 - size, the bytes before it are filled with '0'
+  uint64_t word;
+  std::memcpy(&word, digits.data(), sizeof(word));
+  if (size < 8)
+    word = (word << (64 - 8 * size)) | (ONES * '0' >> (8 * size));
+
+  // Removes the decimal point by moving the digits before it one byte up
+  int fractionDigitCount{ 0 };
+  const uint64_t points{ word ^ (ONES * '.') };
+  if (const uint64_t point{ (points - ONES) & ~points & (ONES * 0x80) }; point != 0)
+  {
+    const int pointIndex{ std::countr_zero(point) / 8 };
+    fractionDigitCount = 7 - pointIndex;
+    const uint64_t integerPart{ pointIndex == 0 ? 0 : word & (~uint64_t{ 0 } >> (64 - 8 * pointIndex)) };
+    const uint64_t fractionPart{ pointIndex == 7 ? 0 : word & (~uint64_t{ 0 } << (8 * pointIndex + 8)) };
+    word = (integerPart << 8) | fractionPart | '0';
+  }
+
+  // All bytes have to be digits now
+  if ((word & (ONES * 0xF0)) != ONES * 0x30 || ((word + ONES * 0x06) & (ONES * 0xF0)) != ONES * 0x30)
+    return PDFParser::ParseDecimal(token, number);
+
+  uint64_t mantissa{ word - ONES * '0' };
+  mantissa = mantissa * 10 + (mantissa >> 8);
+  mantissa = ((mantissa & 0x000000FF000000FF) * (100 + (1000000ull << 32)) +
+              ((mantissa >> 16) & 0x000000FF000000FF) * (1 + (10000ull << 32))) >>
+             32;
+
+  const double value{ static_cast<double>(mantissa) / POWERS_OF_TEN[fractionDigitCount] };
+  number = static_cast<PDFObject::Decimal>(negative ? -value : value);
+  return true;
+}
+
+// Bit i is set if byte i of the chunk is whitespace or a delimiter
+#if defined(__AVX2__)
+template <char... BOUNDARIES>
+uint32_t ClassifyChunk(const char* data)
+{
+  const __m256i chunk{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data)) };
+  __m256i boundaries{ _mm256_setzero_si256() };
+  ((boundaries = _mm256_or_si256(boundaries, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(BOUNDARIES)))), ...);
+  return static_cast<uint32_t>(_mm256_movemask_epi8(boundaries));
+}
+constexpr size_t SIMD_WIDTH{ 32 };
+#elif defined(PDF_CONTENT_LEXER_SSE2)
+template <char... BOUNDARIES>
+uint32_t ClassifyChunk(const char* data)
+{
+  const __m128i chunk{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(data)) };
+  __m128i boundaries{ _mm_setzero_si128() };
+  ((boundaries = _mm_or_si128(boundaries, _mm_cmpeq_epi8(chunk, _mm_set1_epi8(BOUNDARIES)))), ...);
+  return static_cast<uint32_t>(_mm_movemask_epi8(boundaries));
+}
+constexpr size_t SIMD_WIDTH{ 16 };
+#endif
+
+} // namespace
+
+PDFContentLexer::PDFContentLexer(std::string_view data)
+  : m_data(data)
+{
+}
+
+void PDFContentLexer::ClassifyBlock(size_t blockStart)
+{
+  uint64_t boundaries{ 0 };
+  size_t position{ blockStart };
+  const size_t blockEnd{ std::min(blockStart + BLOCK_SIZE, m_data.size()) };
+#if defined(__AVX2__) || defined(PDF_CONTENT_LEXER_SSE2)
+  for (; position + SIMD_WIDTH <= blockEnd; position += SIMD_WIDTH)
+  {
+    const uint32_t chunkBoundaries{
+      ClassifyChunk<' ', '\t', '\r', '\n', '\f', '\0', '(', ')', '<', '>', '[', ']', '{', '}', '/', '%'>(m_data.data() + position)
+    };
+    boundaries |= static_cast<uint64_t>(chunkBoundaries) << (position - blockStart);
+  }
+#endif
+  for (; position < blockEnd; ++position)
+    boundaries |= uint64_t{ GetCharacterClass(m_data[position]) != CharacterClass::Regular } << (position - blockStart);
+
+  m_blockStart = blockStart;
+  m_boundaries = boundaries;
+}
+
+// Inline so they are expanded into Next(), which calls them for every token
+inline void PDFContentLexer::SkipWhitespaceAndComments()
+{
+  while (true)
+  {
+    while (m_position < m_data.size() && GetCharacterClass(m_data[m_position]) == CharacterClass::Whitespace)
+      m_position++;
+    if (m_position == m_data.size() || m_data[m_position] != '%')
+      return;
+    while (m_position < m_data.size() && m_data[m_position] != '\r' && m_data[m_position] != '\n')
+      m_position++;
+  }
+}
+
+inline size_t PDFContentLexer::FindTokenEnd(size_t position)
+{
+  // Most operands and operators are shorter than 8 characters, classifying a block only pays off for longer tokens
+  const size_t scalarEnd{ std::min(position + 8, m_data.size()) };
+  for (; position < scalarEnd; ++position)
+  {
+    if (GetCharacterClass(m_data[position]) != CharacterClass::Regular)
+      return position;
+  }
+  return position < m_data.size() ? FindBoundary(position) : position;
+}
+
+size_t PDFContentLexer::FindBoundary(size_t position)
+{
+  while (position < m_data.size())
+  {
+    if (position < m_blockStart || position - m_blockStart >= BLOCK_SIZE)
+      ClassifyBlock(position - position % BLOCK_SIZE);
+    if (const uint64_t boundaries{ m_boundaries >> (position - m_blockStart) }; boundaries != 0)
+      return position + std::countr_zero(boundaries);
+    position = m_blockStart + BLOCK_SIZE;
+  }
+  return m_data.size();
+}
+
+std::string_view PDFContentLexer::ReadLiteralString()
+{
+  // Balanced parentheses are part of the string, escaped ones are not counted
+  const size_t start{ m_position };
+  int depth{ 1 };
+  while (m_position < m_data.size())
+  {
+    const char c{ m_data[m_position] };
+    if (c == '\\')
+    {
+      m_position += 2;
+      continue;
+    }
+    if (c == '(')
+    {
+      depth++;
+    }
+    else if (c == ')' && --depth == 0)
+    {
+      m_position++;
+      return m_data.substr(start, m_position - 1 - start);
+    }
+    m_position++;
+  }
+
+  // Unterminated string
+  m_position = m_data.size();
+  return m_data.substr(start);
+}
+
+void PDFContentLexer::SkipInlineImageData()
+{
+  // A single whitespace character follows ID, the data ends at an EI which is surrounded by whitespace
+  m_position = std::min(m_position + 1, m_data.size());
+  for (size_t position{ m_data.find("EI", m_position) }; position != std::string_view::npos;
+       position = m_data.find("EI", position + 1))
+  {
+    const bool whitespaceBefore{ position == m_position ||
+                                 GetCharacterClass(m_data[position - 1]) == CharacterClass::Whitespace };
+    const bool separatedAfter{ position + 2 == m_data.size() ||
+                               GetCharacterClass(m_data[position + 2]) != CharacterClass::Regular };
+    if (whitespaceBefore && separatedAfter)
+    {
+      m_position = position;
+      return;
+    }
+  }
+  m_position = m_data.size();
+}
+
+PDFContentLexer::Token PDFContentLexer::Next()
+{
+  SkipWhitespaceAndComments();
+  if (m_position >= m_data.size())
+    return {};
+
+  Token token;
+  const size_t start{ m_position };
+  const char c{ m_data[m_position] };
+
+  // Numbers and operators, which are almost all tokens of a content stream
+  if (GetCharacterClass(c) == CharacterClass::Regular)
+  {
+    m_position = FindTokenEnd(m_position + 1);
+    token.m_text = { m_data.data() + start, m_position - start };
+    if ((PDFParser::IsDigit(c) || c == '.' || c == '-' || c == '+') &&
+        ParseNumber(token.m_text, m_data.size() - start, token.m_number))
+    {
+      token.m_type = Token::Type::Number;
+    }
+    else
+    {
+      token.m_type = Token::Type::Operator;
+      if (token.m_text == "ID")
+        SkipInlineImageData();
+    }
+    return token;
+  }
+
+  m_position++;
+  switch (c)
+  {
+    case '/':
+      m_position = FindTokenEnd(m_position);
+      token.m_type = Token::Type::Name;
+      token.m_text = m_data.substr(start + 1, m_position - start - 1);
+      break;
+    case '(':
+      token.m_type = Token::Type::String;
+      token.m_text = ReadLiteralString();
+      break;
+    case '<':
+      if (m_position < m_data.size() && m_data[m_position] == '<')
+      {
+        m_position++;
+        token.m_type = Token::Type::DictionaryBegin;
+        token.m_text = m_data.substr(start, 2);
+      }
+      else
+      {
+        const size_t end{ std::min(m_data.find('>', m_position), m_data.size()) };
+        m_position = std::min(end + 1, m_data.size());
+        token.m_type = Token::Type::HexString;
+        token.m_text = m_data.substr(start + 1, end - start - 1);
+      }
+      break;
+    case '>':
+      if (m_position < m_data.size() && m_data[m_position] == '>')
+      {
+        m_position++;
+        token.m_type = Token::Type::DictionaryEnd;
+        token.m_text = m_data.substr(start, 2);
+      }
+      else
+      {
+        token.m_type = Token::Type::Operator;
+        token.m_text = m_data.substr(start, 1);
+      }
+      break;
+    case '[':
+      token.m_type = Token::Type::ArrayBegin;
+      token.m_text = m_data.substr(start, 1);
+      break;
+    case ']':
+      token.m_type = Token::Type::ArrayEnd;
+      token.m_text = m_data.substr(start, 1);
+      break;
+    default:
+      // Stray ), { or }
+      token.m_type = Token::Type::Operator;
+      token.m_text = m_data.substr(start, 1);
+      break;
+  }
+  return token;
+}
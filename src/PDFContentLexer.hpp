@@ -0,0 +1,56 @@
+#pragma once
+
+#include "PDFObject.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Splits a content stream into typed tokens following the lexical rules of PDF, tokens are views into the stream data
+class PDFContentLexer
+{
+public:
+  struct Token
+  {
+    enum class Type : uint8_t
+    {
+      End,
+      Number,
+      Name,      // m_text without the slash
+      String,    // m_text without the parentheses, escape sequences are not decoded
+      HexString, // m_text without the angle brackets
+      ArrayBegin,
+      ArrayEnd,
+      DictionaryBegin,
+      DictionaryEnd,
+      Operator, // Also the keywords true, false and null and stray delimiters
+    };
+
+    Type m_type{ Type::End };
+    std::string_view m_text;
+    PDFObject::Decimal m_number{ 0.0f };
+  };
+
+private:
+  static constexpr size_t BLOCK_SIZE{ 64 };
+
+  std::string_view m_data;
+  size_t m_position{ 0 };
+  // Bit i is set if byte m_blockStart + i is whitespace or a delimiter. The bytes are classified with SIMD a block at a
+  // time, so finding the end of a long token is a bit scan.
+  size_t m_blockStart{ SIZE_MAX };
+  uint64_t m_boundaries{ 0 };
+
+  void ClassifyBlock(size_t blockStart);
+  void SkipWhitespaceAndComments();
+  size_t FindTokenEnd(size_t position);
+  size_t FindBoundary(size_t position);
+  std::string_view ReadLiteralString();
+  void SkipInlineImageData();
+
+public:
+  explicit PDFContentLexer(std::string_view data);
+
+  // Returns a token of type End at the end of the data. The data of an inline image is skipped as a whole after its ID
+  // operator, so the next token is its EI operator.
+  Token Next();
+};
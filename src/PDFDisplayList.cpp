@@ -0,0 +1,478 @@
+#include "PDFDisplayList.hpp"
+#include "PDFTessellator.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <iostream>
+#include <optional>
+#include <span>
+#include <unordered_map>
+
+namespace
+{
+// Forms nested deeper than this are rejected when reading, so a damaged file cannot exhaust the stack
+constexpr int MAX_FORM_DEPTH{ 32 };
+
+template<typename T>
+void WriteValues(std::ostream& stream, const T* values, size_t count)
+{
+  stream.write(reinterpret_cast<const char*>(values), static_cast<std::streamsize>(count * sizeof(T)));
+}
+
+template<typename T>
+bool ReadValues(std::string_view& data, T* values, size_t count)
+{
+  if (data.size() < count * sizeof(T))
+    return false;
+  std::memcpy(values, data.data(), count * sizeof(T));
+  data.remove_prefix(count * sizeof(T));
+  return true;
+}
+
+float IndexToOperand(size_t index)
+{
+  return std::bit_cast<float>(static_cast<uint32_t>(index));
+}
+
+uint32_t OperandToIndex(float operand)
+{
+  return std::bit_cast<uint32_t>(operand);
+}
+
+// Line cap style, line join style, stroke color, fill color, line width, the 9 values of the transform, and whether
+// there is a clip followed by its corners
+constexpr size_t STATE_VALUE_COUNT{ 23 };
+
+void WriteState(std::ostream& stream, const GraphicsState& graphicsState)
+{
+  const Vector3& strokeColor{ graphicsState.GetStrokeColor() };
+  const Vector3& fillColor{ graphicsState.GetFillColor() };
+  const float* transform{ graphicsState.GetTransform().Data() };
+  const Rectangle clip{ graphicsState.GetClip().value_or(Rectangle{}) };
+  const float values[STATE_VALUE_COUNT]{ static_cast<float>(graphicsState.GetLineCapStyle()),
+                                         static_cast<float>(graphicsState.GetLineJoinStyle()),
+                                         strokeColor.x,
+                                         strokeColor.y,
+                                         strokeColor.z,
+                                         fillColor.x,
+                                         fillColor.y,
+                                         fillColor.z,
+                                         graphicsState.GetLineWidth(),
+                                         transform[0],
+                                         transform[1],
+                                         transform[2],
+                                         transform[3],
+                                         transform[4],
+                                         transform[5],
+                                         transform[6],
+                                         transform[7],
+                                         transform[8],
+                                         graphicsState.GetClip() ? 1.f : 0.f,
+                                         clip.min.x,
+                                         clip.min.y,
+                                         clip.max.x,
+                                         clip.max.y };
+  WriteValues(stream, values, STATE_VALUE_COUNT);
+}
+
+bool ReadState(std::string_view& data, GraphicsState& graphicsState)
+{
+  float values[STATE_VALUE_COUNT];
+  if (!ReadValues(data, values, STATE_VALUE_COUNT))
+    return false;
+  graphicsState = GraphicsState{};
+  graphicsState.SetLineCapStyle(static_cast<LineCapStyle>(static_cast<int>(values[0])));
+  graphicsState.SetLineJoinStyle(static_cast<LineJoinStyle>(static_cast<int>(values[1])));
+  graphicsState.SetStrokeColor({ values[2], values[3], values[4] });
+  graphicsState.SetFillColor({ values[5], values[6], values[7] });
+  graphicsState.SetLineWidth(values[8]);
+  graphicsState.SetTransform(
+    CTM{ values[9], values[10], values[11], values[12], values[13], values[14], values[15], values[16], values[17] });
+  if (values[18] != 0.f)
+    graphicsState.IntersectClip({ { values[19], values[20] }, { values[21], values[22] } });
+  return true;
+}
+} // namespace
+
+void PDFDisplayList::RecordState(const GraphicsState& graphicsState)
+{
+  const GraphicsStateTable::Index stateIndex{ m_states.Intern(graphicsState) };
+  if (m_hasRecordedState && stateIndex == m_recordedStateIndex)
+    return;
+  m_recordedStateIndex = stateIndex;
+  m_hasRecordedState = true;
+
+  m_opcodes.push_back(Opcode::State);
+  m_operands.push_back(IndexToOperand(stateIndex));
+}
+
+void PDFDisplayList::MoveTo(const Vector2& point)
+{
+  m_opcodes.push_back(Opcode::MoveTo);
+  m_operands.insert(m_operands.end(), { point.x, point.y });
+}
+
+void PDFDisplayList::LineTo(const Vector2& point)
+{
+  m_opcodes.push_back(Opcode::LineTo);
+  m_operands.insert(m_operands.end(), { point.x, point.y });
+}
+
+void PDFDisplayList::CurveTo(const Vector2& p1, const Vector2& p2, const Vector2& p3)
+{
+  m_opcodes.push_back(Opcode::CurveTo);
+  m_operands.insert(m_operands.end(), { p1.x, p1.y, p2.x, p2.y, p3.x, p3.y });
+}
+
+void PDFDisplayList::CurveToDuplicateStartPoint(const Vector2& p2, const Vector2& p3)
+{
+  m_opcodes.push_back(Opcode::CurveToDuplicateStartPoint);
+  m_operands.insert(m_operands.end(), { p2.x, p2.y, p3.x, p3.y });
+}
+
+void PDFDisplayList::ClosePath()
+{
+  m_opcodes.push_back(Opcode::ClosePath);
+}
+
+void PDFDisplayList::PaintPath(const GraphicsState& graphicsState, PathMode pathMode)
+{
+  RecordState(graphicsState);
+  if (pathMode == (PathMode::Fill | PathMode::Stroke))
+    m_opcodes.push_back(Opcode::FillAndStroke);
+  else if (pathMode == PathMode::Fill)
+    m_opcodes.push_back(Opcode::Fill);
+  else
+    m_opcodes.push_back(Opcode::Stroke);
+  m_paintedOpcodeCount = m_opcodes.size();
+  m_paintedOperandCount = m_operands.size();
+  m_paintedPathCount++;
+}
+
+void PDFDisplayList::DiscardPath()
+{
+  m_opcodes.resize(m_paintedOpcodeCount);
+  m_operands.resize(m_paintedOperandCount);
+}
+
+void PDFDisplayList::PaintForm(const GraphicsState& graphicsState,
+                               const std::shared_ptr<const PDFDisplayList>& form,
+                               const CTM& transform)
+{
+  RecordState(graphicsState);
+  const auto [formIndexIt, inserted]{ m_formIndices.try_emplace(form.get(), m_forms.size()) };
+  if (inserted)
+    m_forms.push_back(form);
+
+  const float* values{ transform.Data() };
+  m_opcodes.push_back(Opcode::Form);
+  m_operands.push_back(IndexToOperand(formIndexIt->second));
+  m_operands.insert(m_operands.end(), values, values + 9);
+  m_paintedOpcodeCount = m_opcodes.size();
+  m_paintedOperandCount = m_operands.size();
+}
+
+std::optional<Rectangle> PDFDisplayList::GetCurrentPathBounds() const
+{
+  // The operands of all path construction commands are points
+  const auto coordinates{ std::span{ m_operands }.subspan(m_paintedOperandCount) };
+  if (coordinates.size() < 2)
+    return std::nullopt;
+  Rectangle bounds{ { coordinates[0], coordinates[1] }, { coordinates[0], coordinates[1] } };
+  for (size_t coordinateIndex{ 2 }; coordinateIndex + 1 < coordinates.size(); coordinateIndex += 2)
+  {
+    bounds.min = { std::min(bounds.min.x, coordinates[coordinateIndex]),
+                   std::min(bounds.min.y, coordinates[coordinateIndex + 1]) };
+    bounds.max = { std::max(bounds.max.x, coordinates[coordinateIndex]),
+                   std::max(bounds.max.y, coordinates[coordinateIndex + 1]) };
+  }
+  return bounds;
+}
+
+void PDFDisplayList::SetBoundingBox(const Rectangle& boundingBox)
+{
+  m_boundingBox = boundingBox;
+}
+
+void PDFDisplayList::Replay(PathStore& paths,
+                            std::vector<GraphicsState>& states,
+                            std::vector<FormPlacement>& formPlacements,
+                            ReplayPosition& position) const
+{
+  const auto opcodes{ std::span{ m_opcodes }.subspan(position.m_opcodeIndex,
+                                                     m_paintedOpcodeCount - position.m_opcodeIndex) };
+  size_t pathCount{ 0 };
+  size_t subPathCount{ 1 };
+  size_t pointCount{ 0 };
+  for (Opcode opcode : opcodes)
+  {
+    switch (opcode)
+    {
+      case Opcode::MoveTo:
+        subPathCount++;
+        pointCount++;
+        break;
+      case Opcode::LineTo:
+        pointCount++;
+        break;
+      case Opcode::CurveTo:
+      case Opcode::CurveToDuplicateStartPoint:
+        pointCount += 6; // The steps of the curve and its start point, if the subpath has none yet
+        break;
+      case Opcode::Fill:
+      case Opcode::Stroke:
+      case Opcode::FillAndStroke:
+        pathCount++;
+        subPathCount++;
+        break;
+      default:
+        break;
+    }
+  }
+  paths.Clear();
+  paths.Reserve(pathCount, subPathCount, pointCount);
+  states.clear();
+  formPlacements.clear();
+
+  // Only the states which are used by the paths are copied, once for each of them
+  std::unordered_map<GraphicsStateTable::Index, GraphicsStateTable::Index> copiedStateIndices;
+  GraphicsStateTable::Index stateIndex{ position.m_stateIndex };
+  std::optional<GraphicsStateTable::Index> copiedStateIndex;
+  auto PaintPath{ [&](PathMode pathMode)
+  {
+    if (!copiedStateIndex)
+    {
+      const auto [copiedIt, inserted]{ copiedStateIndices.try_emplace(
+        stateIndex, static_cast<GraphicsStateTable::Index>(states.size())) };
+      if (inserted)
+        states.push_back(m_states[stateIndex]);
+      copiedStateIndex = copiedIt->second;
+    }
+    paths.PaintPath(pathMode, *copiedStateIndex);
+  } };
+
+  const float* operands{ m_operands.data() + position.m_operandIndex };
+  for (Opcode opcode : opcodes)
+  {
+    switch (opcode)
+    {
+      case Opcode::State:
+        stateIndex = OperandToIndex(operands[0]);
+        copiedStateIndex.reset();
+        break;
+      case Opcode::MoveTo:
+        paths.AddNewSubPath();
+        paths.AddPoint({ operands[0], operands[1] });
+        break;
+      case Opcode::LineTo:
+        paths.AddPoint({ operands[0], operands[1] });
+        break;
+      case Opcode::CurveTo:
+        paths.AddBezierCurve({ operands[0], operands[1] }, { operands[2], operands[3] }, { operands[4], operands[5] });
+        break;
+      case Opcode::CurveToDuplicateStartPoint:
+        paths.AddBezierCurveDuplicateStartPoint({ operands[0], operands[1] }, { operands[2], operands[3] });
+        break;
+      case Opcode::ClosePath:
+        paths.CloseSubPath();
+        break;
+      case Opcode::Fill:
+        PaintPath(PathMode::Fill);
+        break;
+      case Opcode::Stroke:
+        PaintPath(PathMode::Stroke);
+        break;
+      case Opcode::FillAndStroke:
+        PaintPath(PathMode::Fill | PathMode::Stroke);
+        break;
+      case Opcode::Form:
+        formPlacements.push_back({ paths.GetPathCount(),
+                                   OperandToIndex(operands[0]),
+                                   CTM{ operands[1],
+                                        operands[2],
+                                        operands[3],
+                                        operands[4],
+                                        operands[5],
+                                        operands[6],
+                                        operands[7],
+                                        operands[8],
+                                        operands[9] },
+                                   m_states[stateIndex].GetClip() });
+        break;
+      default:
+        break;
+    }
+    operands += GetOperandCount(opcode);
+  }
+
+  position = { m_paintedOpcodeCount, m_paintedOperandCount, stateIndex };
+}
+
+size_t PDFDisplayList::GetPaintedPathCount() const
+{
+  return m_paintedPathCount;
+}
+
+const PDFDisplayList& PDFDisplayList::GetForm(size_t formIndex) const
+{
+  return *m_forms[formIndex];
+}
+
+const std::optional<Rectangle>& PDFDisplayList::GetBoundingBox() const
+{
+  return m_boundingBox;
+}
+
+PageTriangles PDFDisplayList::CollectTriangles() const
+{
+  return PDFTessellator{}.Finish(*this);
+}
+
+size_t PDFDisplayList::GetByteSize() const
+{
+  size_t byteSize{ m_opcodes.size() * sizeof(Opcode) + m_operands.size() * sizeof(float) +
+                   m_states.GetSize() * sizeof(GraphicsState) };
+  for (const auto& form : m_forms)
+    byteSize += form->GetByteSize();
+  return byteSize;
+}
+
+bool PDFDisplayList::Write(std::ostream& stream) const
+{
+  // A path which is still being built is not part of the written display list
+  const uint64_t counts[]{ m_paintedOpcodeCount, m_paintedOperandCount, m_forms.size(), m_states.GetSize() };
+  WriteValues(stream, counts, 4);
+  const uint8_t hasBoundingBox{ m_boundingBox.has_value() };
+  WriteValues(stream, &hasBoundingBox, 1);
+  if (m_boundingBox)
+  {
+    WriteValues(stream, &m_boundingBox->min, 1);
+    WriteValues(stream, &m_boundingBox->max, 1);
+  }
+  for (GraphicsStateTable::Index stateIndex{ 0 }; stateIndex < m_states.GetSize(); ++stateIndex)
+    WriteState(stream, m_states[stateIndex]);
+  WriteValues(stream, m_opcodes.data(), m_paintedOpcodeCount);
+  WriteValues(stream, m_operands.data(), m_paintedOperandCount);
+  // Forms painted from several display lists are written once for each of them
+  for (const auto& form : m_forms)
+    form->Write(stream);
+  return static_cast<bool>(stream);
+}
+
+bool PDFDisplayList::Read(std::string_view& data)
+{
+  return Read(data, 0);
+}
+
+bool PDFDisplayList::Read(std::string_view& data, int depth)
+{
+  *this = PDFDisplayList{};
+
+  // The counts are checked against the remaining data before anything is allocated
+  uint64_t counts[4];
+  uint8_t hasBoundingBox{ 0 };
+  if (!ReadValues(data, counts, 4) || !ReadValues(data, &hasBoundingBox, 1) || counts[0] > data.size() ||
+      counts[1] > data.size() / sizeof(float) || counts[2] > data.size() ||
+      counts[3] > data.size() / (STATE_VALUE_COUNT * sizeof(float)) ||
+      counts[0] * sizeof(Opcode) + (counts[1] + counts[3] * STATE_VALUE_COUNT) * sizeof(float) > data.size())
+  {
+    std::cerr << "Display list is truncated\n";
+    return false;
+  }
+  if (hasBoundingBox != 0)
+  {
+    Rectangle boundingBox;
+    if (!ReadValues(data, &boundingBox.min, 1) || !ReadValues(data, &boundingBox.max, 1))
+    {
+      std::cerr << "Display list is truncated\n";
+      return false;
+    }
+    m_boundingBox = boundingBox;
+  }
+  for (uint64_t stateIndex{ 0 }; stateIndex < counts[3]; ++stateIndex)
+  {
+    // The table has no duplicates, a state which is interned again would shift the indices of the following ones
+    GraphicsState graphicsState;
+    if (!ReadState(data, graphicsState) || m_states.Intern(graphicsState) != stateIndex)
+    {
+      std::cerr << "Display list has a damaged graphics state table\n";
+      *this = PDFDisplayList{};
+      return false;
+    }
+  }
+  m_opcodes.resize(counts[0]);
+  m_operands.resize(counts[1]);
+  if (!ReadValues(data, m_opcodes.data(), m_opcodes.size()) || !ReadValues(data, m_operands.data(), m_operands.size()))
+  {
+    std::cerr << "Display list is truncated\n";
+    *this = PDFDisplayList{};
+    return false;
+  }
+
+  size_t operandCount{ 0 };
+  bool hasState{ false };
+  for (Opcode opcode : m_opcodes)
+  {
+    if (opcode >= Opcode::Count)
+    {
+      std::cerr << "Display list contains unknown opcode " << static_cast<int>(opcode) << "\n";
+      *this = PDFDisplayList{};
+      return false;
+    }
+    if (opcode == Opcode::Form && operandCount < m_operands.size() &&
+        OperandToIndex(m_operands[operandCount]) >= counts[2])
+    {
+      std::cerr << "Display list paints form " << OperandToIndex(m_operands[operandCount]) << " of " << counts[2]
+                << "\n";
+      *this = PDFDisplayList{};
+      return false;
+    }
+    if (opcode == Opcode::State && operandCount < m_operands.size() &&
+        OperandToIndex(m_operands[operandCount]) >= counts[3])
+    {
+      std::cerr << "Display list uses graphics state " << OperandToIndex(m_operands[operandCount]) << " of "
+                << counts[3] << "\n";
+      *this = PDFDisplayList{};
+      return false;
+    }
+    hasState = hasState || opcode == Opcode::State;
+    const bool paintsPath{ opcode == Opcode::Fill || opcode == Opcode::Stroke || opcode == Opcode::FillAndStroke };
+    if ((paintsPath || opcode == Opcode::Form) && !hasState)
+    {
+      std::cerr << "Display list paints without a graphics state\n";
+      *this = PDFDisplayList{};
+      return false;
+    }
+    if (paintsPath)
+      m_paintedPathCount++;
+    operandCount += GetOperandCount(opcode);
+  }
+  if (operandCount != m_operands.size())
+  {
+    std::cerr << "Display list has " << m_operands.size() << " operands instead of " << operandCount << "\n";
+    *this = PDFDisplayList{};
+    return false;
+  }
+
+  if (counts[2] > 0 && depth >= MAX_FORM_DEPTH)
+  {
+    std::cerr << "Display list contains forms nested deeper than " << MAX_FORM_DEPTH << "\n";
+    *this = PDFDisplayList{};
+    return false;
+  }
+  for (uint64_t formIndex{ 0 }; formIndex < counts[2]; ++formIndex)
+  {
+    PDFDisplayList form;
+    if (!form.Read(data, depth + 1))
+    {
+      *this = PDFDisplayList{};
+      return false;
+    }
+    m_forms.push_back(std::make_shared<const PDFDisplayList>(std::move(form)));
+    m_formIndices.emplace(m_forms.back().get(), m_forms.size() - 1);
+  }
+
+  m_paintedOpcodeCount = m_opcodes.size();
+  m_paintedOperandCount = m_operands.size();
+  return true;
+}
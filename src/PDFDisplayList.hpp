@@ -0,0 +1,130 @@
+#pragma once
+
+#include "GraphicsState.hpp"
+#include "GraphicsStateTable.hpp"
+#include "PageTriangles.hpp"
+#include "Path.hpp"
+#include "PathStore.hpp"
+#include "math/Rectangle.hpp"
+#include "math/Triangle.hpp"
+#include "math/Vector.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// The interpreted contents of pages as a compact binary command buffer. Each command is an opcode followed by a fixed
+// number of operands, which are kept in a separate array of floats. Indices are stored bit for bit as 32-bit integers
+// in their operand, a float holds integers exactly only up to 2^24. The graphics states are kept in a table, a state
+// command refers to an entry and is only recorded when a path is painted with a state which differs from the previous
+// one. Replaying the commands builds the same paths as interpreting the content streams, without lexing them again.
+// Forms are display lists of their own, which are tessellated once for all of their placements.
+class PDFDisplayList
+{
+public:
+  enum class Opcode : uint8_t
+  {
+    State, // Index of the graphics state
+    MoveTo,
+    LineTo,
+    CurveTo,
+    CurveToDuplicateStartPoint,
+    ClosePath,
+    Fill,
+    Stroke,
+    FillAndStroke,
+    Form, // Index of the form and the 9 values of the transform from the space of the form, after a state for its clip
+    Count,
+  };
+
+  static constexpr size_t GetOperandCount(Opcode opcode)
+  {
+    switch (opcode)
+    {
+      case Opcode::State:
+        return 1;
+      case Opcode::MoveTo:
+      case Opcode::LineTo:
+        return 2;
+      case Opcode::CurveTo:
+        return 6;
+      case Opcode::CurveToDuplicateStartPoint:
+        return 4;
+      case Opcode::Form:
+        return 10;
+      default:
+        return 0;
+    }
+  }
+
+private:
+  std::vector<Opcode> m_opcodes;
+  std::vector<float> m_operands;
+  // End of the commands of the last painted path, the commands after it belong to the current path
+  size_t m_paintedOpcodeCount{ 0 };
+  size_t m_paintedOperandCount{ 0 };
+  size_t m_paintedPathCount{ 0 };
+  GraphicsStateTable m_states;
+  GraphicsStateTable::Index m_recordedStateIndex{ 0 };
+  bool m_hasRecordedState{ false };
+  std::vector<std::shared_ptr<const PDFDisplayList>> m_forms;
+  std::unordered_map<const PDFDisplayList*, size_t> m_formIndices; // Into m_forms
+  std::optional<Rectangle> m_boundingBox; // Of a form, triangles outside of it are dropped
+
+  void RecordState(const GraphicsState& graphicsState);
+  bool Read(std::string_view& data, int depth);
+
+public:
+  struct FormPlacement
+  {
+    size_t m_pathCount{ 0 }; // Number of paths which are painted before the form
+    size_t m_formIndex{ 0 };
+    CTM m_transform{ CTM::Identity() };
+    std::optional<Rectangle> m_clip; // In the space of the display list
+  };
+
+  // The commands which were not replayed yet
+  struct ReplayPosition
+  {
+    size_t m_opcodeIndex{ 0 };
+    size_t m_operandIndex{ 0 };
+    GraphicsStateTable::Index m_stateIndex{ 0 };
+  };
+
+  void MoveTo(const Vector2& point);
+  void LineTo(const Vector2& point);
+  void CurveTo(const Vector2& p1, const Vector2& p2, const Vector2& p3);
+  void CurveToDuplicateStartPoint(const Vector2& p2, const Vector2& p3);
+  void ClosePath();
+  void PaintPath(const GraphicsState& graphicsState, PathMode pathMode);
+  // Removes the commands of the current path, for paths which are ended without painting them
+  void DiscardPath();
+  void PaintForm(const GraphicsState& graphicsState,
+                 const std::shared_ptr<const PDFDisplayList>& form,
+                 const CTM& transform);
+  // Bounds of the points of the current path in its own space, including the control points of curves
+  std::optional<Rectangle> GetCurrentPathBounds() const;
+  void SetBoundingBox(const Rectangle& boundingBox);
+
+  // Builds the paths which were painted since position in painting order, and moves position behind them. The forms
+  // are painted between the paths. The outputs are cleared first. The states of the paths are copied to states, which
+  // the paths refer to by index, so the paths stay valid while more commands are recorded.
+  void Replay(PathStore& paths,
+              std::vector<GraphicsState>& states,
+              std::vector<FormPlacement>& formPlacements,
+              ReplayPosition& position) const;
+  size_t GetPaintedPathCount() const;
+  const PDFDisplayList& GetForm(size_t formIndex) const;
+  const std::optional<Rectangle>& GetBoundingBox() const;
+  PageTriangles CollectTriangles() const;
+  size_t GetByteSize() const;
+
+  bool Write(std::ostream& stream) const;
+  // Reads a display list written by Write from the front of data and removes it from data. The commands are checked,
+  // so a corrupted or truncated display list is rejected instead of replayed.
+  bool Read(std::string_view& data);
+};
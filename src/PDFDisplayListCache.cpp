@@ -0,0 +1,135 @@
+#include "PDFDisplayListCache.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string_view>
+
+namespace
+{
+constexpr uint32_t MAGIC{ 0x4C445047 }; // "GPDL", also rejects files which were written with another byte order
+constexpr uint32_t VERSION{ 6 };
+
+template<typename T>
+void WriteValue(std::ostream& stream, const T& value)
+{
+  stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+bool ReadValue(std::string_view& data, T& value)
+{
+  if (data.size() < sizeof(T))
+    return false;
+  std::memcpy(&value, data.data(), sizeof(T));
+  data.remove_prefix(sizeof(T));
+  return true;
+}
+} // namespace
+
+PDFDisplayListCache::PDFDisplayListCache(const std::filesystem::path& sourceFile)
+{
+  std::error_code error;
+  const std::filesystem::path absoluteSourceFile{ std::filesystem::absolute(sourceFile, error) };
+  m_sourceFile = absoluteSourceFile.string();
+  m_sourceFileSize = std::filesystem::file_size(absoluteSourceFile, error);
+  m_sourceFileTime = std::filesystem::last_write_time(absoluteSourceFile, error).time_since_epoch().count();
+
+  const std::filesystem::path cacheDirectory{ std::filesystem::temp_directory_path(error) / "GpuPDF" };
+  m_cacheFile = cacheDirectory / (std::to_string(std::hash<std::string>{}(m_sourceFile)) + ".gpdl");
+}
+
+bool PDFDisplayListCache::Load(std::vector<Page>& pages) const
+{
+  // Read as a whole, the display lists are copied out of it
+  std::ifstream stream{ m_cacheFile, std::ios::binary | std::ios::ate };
+  if (!stream)
+    return false;
+  std::string contents(static_cast<size_t>(stream.tellg()), '\0');
+  if (!stream.seekg(0).read(contents.data(), static_cast<std::streamsize>(contents.size())))
+    return false;
+  std::string_view data{ contents };
+
+  uint32_t magic{ 0 };
+  uint32_t version{ 0 };
+  uintmax_t sourceFileSize{ 0 };
+  int64_t sourceFileTime{ 0 };
+  uint64_t sourceFileLength{ 0 };
+  if (!ReadValue(data, magic) || !ReadValue(data, version) || magic != MAGIC || version != VERSION ||
+      !ReadValue(data, sourceFileSize) || !ReadValue(data, sourceFileTime) || !ReadValue(data, sourceFileLength))
+    return false;
+  if (sourceFileSize != m_sourceFileSize || sourceFileTime != m_sourceFileTime || sourceFileLength > data.size() ||
+      data.substr(0, sourceFileLength) != m_sourceFile)
+    return false;
+  data.remove_prefix(sourceFileLength);
+
+  uint64_t pageCount{ 0 };
+  if (!ReadValue(data, pageCount))
+    return false;
+  std::vector<Page> loadedPages;
+  loadedPages.reserve(std::min<uint64_t>(pageCount, data.size()));
+  for (uint64_t pageIndex{ 0 }; pageIndex < pageCount; ++pageIndex)
+  {
+    Page& page{ loadedPages.emplace_back() };
+    uint64_t objectIdCount{ 0 };
+    if (!ReadValue(data, page.m_pageId) || !ReadValue(data, page.m_drawArea.min) ||
+        !ReadValue(data, page.m_drawArea.max) || !page.m_displayList.Read(data) || !ReadValue(data, objectIdCount) ||
+        objectIdCount > data.size() / sizeof(PDFObject::ID))
+    {
+      std::cerr << "Display list cache " << m_cacheFile << " is damaged\n";
+      return false;
+    }
+    page.m_objectIds.resize(objectIdCount);
+    for (PDFObject::ID& objectId : page.m_objectIds)
+      ReadValue(data, objectId);
+  }
+
+  pages = std::move(loadedPages);
+  return true;
+}
+
+bool PDFDisplayListCache::Save(const std::vector<Page>& pages) const
+{
+  std::error_code error;
+  std::filesystem::create_directories(m_cacheFile.parent_path(), error);
+
+  // Written to another file first, so a concurrent Load never sees a partial cache
+  std::filesystem::path temporaryFile{ m_cacheFile };
+  temporaryFile += ".tmp";
+  {
+    std::ofstream stream{ temporaryFile, std::ios::binary | std::ios::trunc };
+    WriteValue(stream, MAGIC);
+    WriteValue(stream, VERSION);
+    WriteValue(stream, m_sourceFileSize);
+    WriteValue(stream, m_sourceFileTime);
+    WriteValue(stream, static_cast<uint64_t>(m_sourceFile.size()));
+    stream.write(m_sourceFile.data(), static_cast<std::streamsize>(m_sourceFile.size()));
+    WriteValue(stream, static_cast<uint64_t>(pages.size()));
+    for (const Page& page : pages)
+    {
+      WriteValue(stream, page.m_pageId);
+      WriteValue(stream, page.m_drawArea.min);
+      WriteValue(stream, page.m_drawArea.max);
+      page.m_displayList.Write(stream);
+      WriteValue(stream, static_cast<uint64_t>(page.m_objectIds.size()));
+      for (PDFObject::ID objectId : page.m_objectIds)
+        WriteValue(stream, objectId);
+    }
+    if (!stream)
+    {
+      std::cerr << "Failed to write display list cache " << temporaryFile << "\n";
+      stream.close();
+      std::filesystem::remove(temporaryFile, error);
+      return false;
+    }
+  }
+
+  std::filesystem::rename(temporaryFile, m_cacheFile, error);
+  if (error)
+  {
+    std::cerr << "Failed to write display list cache " << m_cacheFile << ": " << error.message() << "\n";
+    return false;
+  }
+  return true;
+}
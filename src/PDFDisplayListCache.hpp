@@ -0,0 +1,37 @@
+#pragma once
+
+#include "PDFDisplayList.hpp"
+#include "PDFObject.hpp"
+#include "math/Rectangle.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Stores the display lists of all pages of a document in a file in the temporary directory, so opening the same
+// document again replays them instead of interpreting its content streams. The file is only used while the size and
+// modification time of the document are the same as when it was written.
+class PDFDisplayListCache
+{
+public:
+  struct Page
+  {
+    PDFObject::ID m_pageId{ -1 };
+    Rectangle m_drawArea;
+    PDFDisplayList m_displayList;
+    std::vector<PDFObject::ID> m_objectIds; // Every object the page was built from, to find the pages of an update
+  };
+
+private:
+  std::filesystem::path m_cacheFile;
+  std::string m_sourceFile;
+  uintmax_t m_sourceFileSize{ 0 };
+  int64_t m_sourceFileTime{ 0 };
+
+public:
+  explicit PDFDisplayListCache(const std::filesystem::path& sourceFile);
+
+  // Fails if there is no cache file or it belongs to another version of the document
+  bool Load(std::vector<Page>& pages) const;
+  bool Save(const std::vector<Page>& pages) const;
+};
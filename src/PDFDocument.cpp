@@ -1,314 +1,743 @@
 #include "PDFDocument.hpp"
+#include "PDFFilter.hpp"
+#include "PDFParser.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <execution>
 #include <fstream>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <ranges>
+#include <thread>
+#include <unordered_set>
 
 namespace
 {
-void NotImplemented(const std::string& function)
+// Object IDs are ints, an xref section which lists objects beyond them is damaged
+constexpr PDFObject::Integer MAX_OBJECT_COUNT{ std::numeric_limits<PDFObject::ID>::max() };
+
+// Finds "<object ID> <generation> obj" headers whose "j" lies in [rangeBegin, rangeEnd)
+void FindObjectHeaders(std::string_view data,
+                       size_t rangeBegin,
+                       size_t rangeEnd,
+                       std::vector<std::pair<PDFObject::ID, size_t>>& headers)
 {
-  std::cerr << function << " not implemented\n";
-}
+  // "j" is rare outside of object headers, memchr skips to the candidates with vectorized code
+  const char* begin{ data.data() };
+  const char* end{ data.data() + data.size() };
+  const char* searchEnd{ data.data() + rangeEnd };
+  for (const char* j{ static_cast<const char*>(std::memchr(begin + rangeBegin, 'j', rangeEnd - rangeBegin)) };
+       j != nullptr;
+       j = static_cast<const char*>(std::memchr(j + 1, 'j', static_cast<size_t>(searchEnd - j - 1))))
+  {
+    // Match "<object ID> <generation> obj" followed by a whitespace or a delimiter
+    if (j - begin < 6 || j[-2] != 'o' || j[-1] != 'b' || (j + 1 != end && !PDFParser::IsWhitespace(j[1]) &&
+                                                          !PDFParser::IsDelimiter(j[1])))
+      continue;
 
-char PeekChar(std::istream& in)
-{
-  return static_cast<char>(in.peek());
+    const char* position{ j - 3 };
+    auto SkipBackwards{ [&](auto predicate)
+    {
+      const char* start{ position };
+      while (position >= begin && predicate(*position))
+        position--;
+      return position != start;
+    } };
+    if (!SkipBackwards(PDFParser::IsWhitespace) || !SkipBackwards(PDFParser::IsDigit) ||
+        !SkipBackwards(PDFParser::IsWhitespace))
+      continue;
+    const char* objectIdEnd{ position + 1 };
+    if (!SkipBackwards(PDFParser::IsDigit) ||
+        (position >= begin && !PDFParser::IsWhitespace(*position) && !PDFParser::IsDelimiter(*position)))
+      continue;
+
+    PDFObject::Integer objectId;
+    if (PDFParser::ParseInteger(std::string_view(position + 1, static_cast<size_t>(objectIdEnd - position - 1)),
+                                objectId) &&
+        objectId >= 0 && static_cast<size_t>(objectId) <= data.size())
+      headers.emplace_back(static_cast<PDFObject::ID>(objectId), static_cast<size_t>(position + 1 - begin));
+  }
 }
 
-char GetChar(std::istream& in)
+std::vector<std::pair<PDFObject::ID, size_t>> FindObjectHeaders(std::string_view data)
 {
-  return static_cast<char>(in.get());
+  // The chunks are scanned concurrently, a header can start in the previous chunk as the scan looks backwards
+  constexpr size_t CHUNK_SIZE{ 16 << 20 };
+  size_t chunkCount{ (data.size() + CHUNK_SIZE - 1) / CHUNK_SIZE };
+  std::vector<std::vector<std::pair<PDFObject::ID, size_t>>> chunkHeaders(chunkCount);
+
+  std::ranges::iota_view chunkIndexView{ size_t{ 0 }, chunkCount };
+  std::for_each(std::execution::par,
+                chunkIndexView.begin(),
+                chunkIndexView.end(),
+                [&](size_t chunkIndex)
+  {
+    FindObjectHeaders(data,
+                      chunkIndex * CHUNK_SIZE,
+                      std::min(data.size(), (chunkIndex + 1) * CHUNK_SIZE),
+                      chunkHeaders[chunkIndex]);
+  });
+
+  std::vector<std::pair<PDFObject::ID, size_t>> headers;
+  for (const auto& chunk : chunkHeaders)
+    headers.insert(headers.end(), chunk.begin(), chunk.end());
+  return headers;
 }
+} // namespace
 
-bool IsWhitespace(char c)
+bool PDFDocument::Load(const std::filesystem::path& path, LoadMode mode)
 {
-  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+  m_path = path;
+  m_previousMappings.clear();
+  if (m_mappedFile.Open(path))
+  {
+    m_data = m_mappedFile.GetData();
+    return Parse(mode);
+  }
+
+  std::ifstream in{ path, std::ios::binary };
+  return Load(in, mode);
 }
 
-bool IsDigit(char c)
+bool PDFDocument::Load(std::istream& in, LoadMode mode)
 {
-  return c >= '0' && c <= '9';
+  m_mappedFile.Close();
+  m_previousMappings.clear();
+  m_buffer.assign(std::istreambuf_iterator<char>{ in }, std::istreambuf_iterator<char>{});
+  m_data = m_buffer;
+  return Parse(mode);
 }
 
-bool IsSpecialChar(char c)
+bool PDFDocument::Reload(std::vector<PDFObject::ID>& changedObjectIds)
 {
-  return c == '/' || c == '<' || c == '>' || c == '[' || c == ']' || c == '(' || c == ')';
+  changedObjectIds.clear();
+  if (!m_mappedFile.IsOpen())
+    return false;
+
+  MappedFile mappedFile;
+  if (!mappedFile.Open(m_path))
+    return false;
+  std::string_view data{ mappedFile.GetData() };
+
+  // An incremental update only appends to the file, the previous tail must still be in place
+  size_t compareLength{ std::min<size_t>(m_data.size(), 1024) };
+  if (data.size() <= m_data.size() || data.substr(m_data.size() - compareLength, compareLength) !=
+                                        m_data.substr(m_data.size() - compareLength, compareLength))
+    return false;
+
+  m_previousMappings.push_back(std::move(m_mappedFile));
+  m_mappedFile = std::move(mappedFile);
+  m_data = data;
+
+  size_t xrefOffset;
+  std::vector<XRefEntry> xref;
+  PDFObject trailer;
+  if (!ReadXRefOffset(xrefOffset) || !ParseXRefChain(xrefOffset, m_xrefOffset, xref, trailer))
+    return false;
+
+  m_xrefOffset = xrefOffset;
+  m_trailer = trailer;
+  m_xref.resize(std::max(m_xref.size(), xref.size()));
+
+  std::lock_guard objectsLock{ m_objectsMutex };
+  std::lock_guard objectStreamsLock{ m_objectStreamsMutex };
+  for (size_t objectId{ 0 }; objectId < xref.size(); objectId++)
+  {
+    if (xref[objectId].m_type == XRefEntry::Type::Undefined)
+      continue;
+    m_xref[objectId] = xref[objectId];
+    m_objects.erase(static_cast<PDFObject::ID>(objectId));
+    if (auto objectStream{ m_objectStreams.extract(static_cast<PDFObject::ID>(objectId)) })
+      m_previousObjectStreams.push_back(std::move(objectStream));
+    m_streamCache.Erase(static_cast<PDFObject::ID>(objectId));
+    changedObjectIds.push_back(static_cast<PDFObject::ID>(objectId));
+  }
+
+  return true;
 }
 
-void SkipWhitespace(std::istream& in)
+bool PDFDocument::Parse(LoadMode mode)
 {
-  while (true)
+  m_objects.clear();
+  m_objectStreams.clear();
+  m_previousObjectStreams.clear();
+  m_streamCache.Clear();
+  m_xref.clear();
+  m_trailer = PDFObject{};
+  m_arena.Clear();
+  m_names.Clear();
+
+  bool xrefValid{ ReadXRefOffset(m_xrefOffset) && ParseXRefChain(m_xrefOffset, m_data.size(), m_xref, m_trailer) };
+  // Wrong offsets show up as a catalog which cannot be resolved
+  if (!xrefValid || !m_trailer.IsDictionary() || !m_trailer.GetDictionary().contains(PDFName::Root) ||
+      !Resolve(m_trailer.GetDictionary().at(PDFName::Root)).IsDictionary())
   {
-    if (IsWhitespace(PeekChar(in)))
-      GetChar(in);
-    else
-      break;
+    std::cerr << "Cross-reference table is damaged, reconstructing it\n";
+    if (!ReconstructXRef())
+      return false;
   }
+
+  if (mode == LoadMode::Eager)
+    ResolveAll();
+
+  return true;
 }
 
-PDFObject::Name ReadName(std::istream& in)
+bool PDFDocument::ReadXRefOffset(size_t& xrefOffset) const
 {
-  PDFObject::Name name;
-  while (!IsWhitespace(PeekChar(in)) && !IsSpecialChar(PeekChar(in)))
-    name += static_cast<char>(GetChar(in));
-  return name;
+  // Some writers add garbage or several line breaks after %%EOF, so look further back than the 30 bytes needed
+  std::string_view trailer{ m_data.substr(m_data.size() - std::min<size_t>(m_data.size(), 1024)) };
+  size_t startxrefOffset{ trailer.rfind("startxref") };
+  if (startxrefOffset == std::string_view::npos)
+    return false;
+
+  PDFParser parser{ m_data, m_data.size() - trailer.size() + startxrefOffset + 9 };
+  PDFObject::Integer offset;
+  if (!parser.ReadInteger(offset) || offset < 0 || static_cast<size_t>(offset) >= m_data.size())
+    return false;
+
+  xrefOffset = static_cast<size_t>(offset);
+  return true;
 }
 
-PDFObject ReadObject(std::istream& in)
+bool PDFDocument::ParseXRefChain(size_t xrefOffset,
+                                 size_t stopOffset,
+                                 std::vector<XRefEntry>& xref,
+                                 PDFObject& trailer) const
 {
-  SkipWhitespace(in);
-
-  char c{ static_cast<char>(PeekChar(in)) };
-  if ((c >= '0' && c <= '9') || c == '.' || c == '-')
+  // Sections are read from the newest to the oldest following /Prev, entries of newer sections take precedence
+  std::unordered_set<size_t> visitedOffsets;
+  bool newestSection{ true };
+  while (xrefOffset != stopOffset && visitedOffsets.insert(xrefOffset).second)
   {
-    std::string s;
-    while (!IsWhitespace(PeekChar(in)) && !IsSpecialChar(PeekChar(in)))
-      s += static_cast<char>(GetChar(in));
-    if (s.find_first_of('.') != std::string::npos)
+    PDFObject sectionTrailer;
+    if (!ParseXRefSection(xrefOffset, xref, sectionTrailer))
+      return !newestSection; // Keep what was read so far if an older section is broken
+    if (!sectionTrailer.IsDictionary())
+      break;
+
+    const PDFObject::Dictionary& dictionary{ sectionTrailer.GetDictionary() };
+    // Hybrid files list objects in object streams in an additional xref stream which precedes the /Prev section
+    if (const PDFObject::Integer xrefStreamOffset{ dictionary.at(PDFName::XRefStm).GetInteger() };
+        xrefStreamOffset > 0 && static_cast<size_t>(xrefStreamOffset) < m_data.size())
     {
-      PDFObject pdfObject;
-      pdfObject.SetDecimal(std::stof(s));
-      return pdfObject;
+      PDFObject xrefStreamTrailer;
+      ParseXRefSection(static_cast<size_t>(xrefStreamOffset), xref, xrefStreamTrailer);
     }
 
-    PDFObject::Integer number{ std::stoll(s) };
+    if (newestSection)
+      trailer = sectionTrailer;
+    newestSection = false;
 
-    int64_t positionBeforePeek{ in.tellg() };
+    const PDFObject::Integer previousXRefOffset{ dictionary.at(PDFName::Prev).GetInteger() };
+    if (!dictionary.contains(PDFName::Prev) || previousXRefOffset < 0 ||
+        static_cast<size_t>(previousXRefOffset) >= m_data.size())
+      break;
+    xrefOffset = static_cast<size_t>(previousXRefOffset);
+  }
+
+  return true;
+}
 
-    if (IsWhitespace(PeekChar(in)))
+bool PDFDocument::ParseXRefSection(size_t offset, std::vector<XRefEntry>& xref, PDFObject& trailer) const
+{
+  // PDF 1.5 and later can store the xref table as a stream object instead of the classic "xref" section
+  PDFParser parser{ m_data, offset };
+  parser.SkipWhitespace();
+  if (parser.ReadToken() == "xref")
+    return ParseXRefTable(parser, xref, trailer);
+  return ParseXRefStream(offset, xref, trailer);
+}
+
+bool PDFDocument::ParseXRefTable(PDFParser& parser, std::vector<XRefEntry>& xref, PDFObject& trailer) const
+{
+  // A section consists of subsections, each starting with the first object ID and the number of entries
+  while (true)
+  {
+    parser.SkipWhitespace();
+    std::string_view token{ parser.ReadToken() };
+    if (token == "trailer")
+      break;
+
+    PDFObject::Integer firstObject, objectCount;
+    if (!PDFParser::ParseInteger(token, firstObject) || !parser.ReadInteger(objectCount) || firstObject < 0 ||
+        objectCount < 0)
+      return false;
+    // Every entry takes 20 bytes, this guards against allocating a huge table for a corrupted header. The tables of
+    // a file cannot list more objects than it has room for, which bounds the object IDs as well.
+    const PDFObject::Integer maxObjectCount{ std::min<PDFObject::Integer>(
+      static_cast<PDFObject::Integer>(m_data.size() / 20), MAX_OBJECT_COUNT) };
+    if (static_cast<size_t>(objectCount) > (m_data.size() - parser.GetPosition()) / 20 ||
+        firstObject > maxObjectCount || objectCount > maxObjectCount - firstObject)
+      return false;
+
+    xref.resize(std::max(xref.size(), static_cast<size_t>(firstObject + objectCount)));
+    for (PDFObject::Integer i{ 0 }; i < objectCount; i++)
     {
-      SkipWhitespace(in);
-      if (IsDigit(PeekChar(in)))
+      PDFObject::Integer byteOffset, generationNumber;
+      if (!parser.ReadInteger(byteOffset) || !parser.ReadInteger(generationNumber))
+        return false;
+      parser.SkipWhitespace();
+
+      XRefEntry entry;
+      if (parser.ReadToken() == "f")
+      {
+        entry.m_type = XRefEntry::Type::Free;
+      }
+      else
       {
-        int potentialGenerationNumber;
-        in >> potentialGenerationNumber;
-        if (IsWhitespace(PeekChar(in)))
-        {
-          char potentialReferenceSpecifier;
-          in >> potentialReferenceSpecifier;
-          if (potentialReferenceSpecifier == 'R')
-          {
-            PDFObject pdfObject;
-            pdfObject.SetReference(static_cast<PDFObject::Reference>(number));
-            return pdfObject;
-          }
-        }
+        entry.m_type = XRefEntry::Type::Uncompressed;
+        entry.m_offset = static_cast<size_t>(byteOffset);
       }
+      SetXRefEntry(xref, static_cast<size_t>(firstObject + i), entry);
     }
+  }
 
-    // TODO: Seek only if tried to read reference and failed
-    in.seekg(positionBeforePeek, std::ios::beg);
+  trailer = parser.ReadObject(m_arena, m_names);
+  return true;
+}
 
-    PDFObject pdfObject;
-    pdfObject.SetInteger(number);
-    return pdfObject;
-  }
-  else if (c == 'n')
+bool PDFDocument::ParseXRefStream(size_t offset, std::vector<XRefEntry>& xref, PDFObject& trailer) const
+{
+  PDFObject xrefStream{ ParseObjectAt(offset, m_arena, m_names) };
+  if (!xrefStream.HasStream() || !xrefStream.GetDictionary().contains(PDFName::W))
+    return false;
+  const PDFObject::Dictionary& dictionary{ xrefStream.GetDictionary() };
+
+  const PDFObject::Array& widthArray{ dictionary.at(PDFName::W).GetArray() };
+  if (widthArray.size() != 3)
+    return false;
+  std::array<size_t, 3> widths;
+  for (size_t i{ 0 }; i < widths.size(); i++)
+    widths[i] = static_cast<size_t>(std::clamp<PDFObject::Integer>(widthArray[i].GetInteger(), 0, 8));
+  size_t entrySize{ widths[0] + widths[1] + widths[2] };
+  if (entrySize == 0)
+    return false;
+
+  // /Size is one more than the highest object ID, it bounds the entries of a corrupted /Index
+  PDFObject::Integer maxObjectCount{ std::min<PDFObject::Integer>(static_cast<PDFObject::Integer>(m_data.size()),
+                                                                  MAX_OBJECT_COUNT) };
+  if (dictionary.contains(PDFName::Size) && dictionary.at(PDFName::Size).GetInteger() >= 0)
+    maxObjectCount = std::min(maxObjectCount, dictionary.at(PDFName::Size).GetInteger());
+
+  std::vector<PDFObject::Integer> subsections;
+  if (dictionary.contains(PDFName::Index))
   {
-    for (int i{ 0 }; i < 4; i++)
-      GetChar(in);
-    PDFObject pdfObject;
-    pdfObject.SetNull();
-    return pdfObject;
+    for (const PDFObject& value : dictionary.at(PDFName::Index).GetArray())
+      subsections.push_back(value.GetInteger());
   }
-  else if (c == 't')
+  else if (dictionary.contains(PDFName::Size))
   {
-    for (int i{ 0 }; i < 4; i++)
-      GetChar(in);
-    PDFObject pdfObject;
-    pdfObject.SetBoolean(true);
-    return pdfObject;
+    subsections = { 0, dictionary.at(PDFName::Size).GetInteger() };
   }
-  else if (c == 'f')
+
+  std::string data{ xrefStream.GetStream() };
+  size_t dataOffset{ 0 };
+
+  // Fields are big-endian, a missing type field defaults to 1 (uncompressed object)
+  auto ReadField{ [&](size_t width, size_t defaultValue)
+  {
+    if (width == 0)
+      return defaultValue;
+    size_t value{ 0 };
+    for (size_t i{ 0 }; i < width; i++)
+      value = (value << 8) | static_cast<unsigned char>(data[dataOffset++]);
+    return value;
+  } };
+
+  for (size_t subsection{ 0 }; subsection + 1 < subsections.size(); subsection += 2)
   {
-    for (int i{ 0 }; i < 5; i++)
-      GetChar(in);
-    PDFObject pdfObject;
-    pdfObject.SetBoolean(false);
-    return pdfObject;
+    PDFObject::Integer firstObject{ subsections[subsection] };
+    PDFObject::Integer objectCount{ subsections[subsection + 1] };
+    if (firstObject < 0 || objectCount < 0 || firstObject > maxObjectCount ||
+        objectCount > maxObjectCount - firstObject)
+      return false;
+    objectCount = std::min(objectCount, static_cast<PDFObject::Integer>((data.size() - dataOffset) / entrySize));
+
+    xref.resize(std::max(xref.size(), static_cast<size_t>(firstObject + objectCount)));
+    for (PDFObject::Integer i{ 0 }; i < objectCount; i++)
+    {
+      size_t type{ ReadField(widths[0], 1) };
+      size_t field2{ ReadField(widths[1], 0) };
+      size_t field3{ ReadField(widths[2], 0) };
+
+      XRefEntry entry;
+      if (type == 0)
+      {
+        entry.m_type = XRefEntry::Type::Free;
+      }
+      else if (type == 1)
+      {
+        entry.m_type = XRefEntry::Type::Uncompressed;
+        entry.m_offset = field2;
+      }
+      else if (type == 2)
+      {
+        entry.m_type = XRefEntry::Type::Compressed;
+        entry.m_objectStreamId = static_cast<PDFObject::ID>(field2);
+        entry.m_objectStreamIndex = field3;
+      }
+      else
+      {
+        continue; // Unknown types are treated as references to the null object
+      }
+      SetXRefEntry(xref, static_cast<size_t>(firstObject + i), entry);
+    }
   }
-  else if (c == '/')
+
+  // The dictionary of the xref stream also serves as the trailer
+  trailer = xrefStream;
+  return true;
+}
+
+bool PDFDocument::ReconstructXRef()
+{
   {
-    GetChar(in);
-    PDFObject pdfObject;
-    pdfObject.SetName(ReadName(in));
-    return pdfObject;
+    std::lock_guard objectsLock{ m_objectsMutex };
+    std::lock_guard objectStreamsLock{ m_objectStreamsMutex };
+    m_objects.clear();
+    m_objectStreams.clear();
   }
-  else if (c == '(')
+  m_streamCache.Clear();
+  m_xref.clear();
+  m_trailer = PDFObject{};
+
+  // Later definitions of an object replace earlier ones, just like with incremental updates
+  std::vector<std::pair<PDFObject::ID, size_t>> headers{ FindObjectHeaders(m_data) };
+  if (headers.empty())
+    return false;
+  // Object numbers are dense in practice, a stray "<number> 0 obj" in stream data must not size the table. The limit
+  // grows with the number of objects which were found.
+  auto GetMaxObjectCount{ [](size_t foundObjectCount) { return foundObjectCount * 4 + 64; } };
+  auto AddHeaders{ [&](size_t beginObjectId, size_t endObjectId)
   {
-    GetChar(in);
-    int openParanthesisCount{ 1 };
-    PDFObject::String string;
-    while (openParanthesisCount > 0)
+    for (const auto& [objectId, offset] : headers)
     {
-      c = GetChar(in);
-      if (c == '(')
-        openParanthesisCount++;
-      if (c == ')')
-        openParanthesisCount--;
-      if (openParanthesisCount > 0)
-        string += c;
+      if (static_cast<size_t>(objectId) < beginObjectId || static_cast<size_t>(objectId) >= endObjectId)
+        continue;
+      m_xref.resize(std::max(m_xref.size(), static_cast<size_t>(objectId) + 1));
+      m_xref[objectId].m_type = XRefEntry::Type::Uncompressed;
+      m_xref[objectId].m_offset = offset;
     }
+  } };
+  const size_t headerObjectCount{ GetMaxObjectCount(headers.size()) };
+  AddHeaders(0, headerObjectCount);
+
+  // Objects inside of object streams are invisible to the scan, they are taken from the index of each object stream.
+  // The limit depends on their number, so the object streams are parsed at their header instead of through the table.
+  std::vector<std::pair<PDFObject::ID, ObjectStream>> objectStreams;
+  size_t compressedObjectCount{ 0 };
+  size_t previousObjectStreamOffset{ std::string_view::npos };
+  for (size_t position{ m_data.find("/ObjStm") }; position != std::string_view::npos;
+       position = m_data.find("/ObjStm", position + 1))
+  {
+    auto header{ std::ranges::upper_bound(headers, position, {}, [](const auto& entry) { return entry.second; }) };
+    if (header == headers.begin())
+      continue;
+    const auto [objectStreamId, objectStreamOffset]{ *std::prev(header) };
+    if (objectStreamOffset == previousObjectStreamOffset)
+      continue;
+    previousObjectStreamOffset = objectStreamOffset;
 
-    PDFObject pdfObject;
-    pdfObject.SetString(string);
-    return pdfObject;
+    ObjectStream objectStream{ ReadObjectStream(ParseObjectAt(objectStreamOffset, m_arena, m_names, objectStreamId)) };
+    compressedObjectCount += objectStream.m_objectIds.size();
+    objectStreams.emplace_back(objectStreamId, std::move(objectStream));
   }
-  else if (c == '<')
+
+  // Objects of the file take precedence over objects of object streams, newer object streams over older ones
+  const size_t maxObjectCount{ GetMaxObjectCount(headers.size() + compressedObjectCount) };
+  AddHeaders(headerObjectCount, maxObjectCount);
+  for (auto& [objectStreamId, objectStream] : std::views::reverse(objectStreams))
   {
-    GetChar(in);
-    if (PeekChar(in) == '<')
+    if (static_cast<size_t>(objectStreamId) >= maxObjectCount)
+      continue;
+
+    std::lock_guard lock{ m_objectStreamsMutex };
+    auto [it, inserted]{ m_objectStreams.try_emplace(objectStreamId, std::move(objectStream)) };
+    if (!inserted)
+      continue;
+    const std::vector<PDFObject::ID>& objectIds{ it->second.m_objectIds };
+    for (size_t i{ 0 }; i < objectIds.size(); i++)
     {
-      GetChar(in);
-      PDFObject pdfObject;
-      SkipWhitespace(in);
-      while (PeekChar(in) != '>')
+      const PDFObject::ID objectId{ objectIds[i] };
+      if (objectId < 0 || static_cast<size_t>(objectId) >= maxObjectCount)
+        continue;
+      m_xref.resize(std::max(m_xref.size(), static_cast<size_t>(objectId) + 1));
+      if (m_xref[objectId].m_type == XRefEntry::Type::Undefined)
       {
-        GetChar(in);
-        PDFObject::Name dictionaryKey{ ReadName(in) };
-        PDFObject dictionaryValue{ ReadObject(in) };
-        pdfObject.AddDictionaryEntry(dictionaryKey, dictionaryValue);
-        SkipWhitespace(in);
+        m_xref[objectId].m_type = XRefEntry::Type::Compressed;
+        m_xref[objectId].m_objectStreamId = objectStreamId;
+        m_xref[objectId].m_objectStreamIndex = i;
       }
-      GetChar(in);
-      GetChar(in);
-      return pdfObject;
     }
-    else
+  }
+
+  for (size_t trailerOffset{ m_data.rfind("trailer") }; trailerOffset != std::string_view::npos;
+       trailerOffset = trailerOffset == 0 ? std::string_view::npos : m_data.rfind("trailer", trailerOffset - 1))
+  {
+    PDFParser parser{ m_data, trailerOffset + 7 };
+    PDFObject trailer{ parser.ReadObject(m_arena, m_names) };
+    if (trailer.IsDictionary() && trailer.GetDictionary().contains(PDFName::Root))
     {
-      PDFObject::String string;
-      bool running{ true };
-      auto convertNibble{ [](char n) -> char
-      {
-        if (n >= 'a' && n <= 'f')
-          return n - 'a' + 10;
-        else if (n >= 'A' && n <= 'F')
-          return n - 'A' + 10;
-        return n - '0';
-      } };
-      while (running)
-      {
-        char upperNibble = GetChar(in);
-        if (upperNibble == '>')
-          break;
-        char lowerNibble = GetChar(in);
-        if (lowerNibble == '>')
-        {
-          lowerNibble = 0;
-          running = false;
-        }
-        else
-          lowerNibble = convertNibble(lowerNibble);
-        upperNibble = convertNibble(upperNibble);
-
-        c = static_cast<char>(upperNibble << 4) | lowerNibble;
-        string += c;
-      }
-      PDFObject pdfObject;
-      pdfObject.SetString(string);
-      return pdfObject;
+      m_trailer = trailer;
+      return true;
     }
   }
-  else if (c == '[')
+
+  // Without a usable trailer, create one which points to the catalog
+  for (size_t objectId{ 0 }; objectId < m_xref.size(); objectId++)
   {
-    GetChar(in);
-    PDFObject pdfObject;
-    SkipWhitespace(in);
-    while (PeekChar(in) != ']')
+    const PDFObject& pdfObject{ GetObject(static_cast<PDFObject::ID>(objectId)) };
+    if (pdfObject.IsDictionary() && pdfObject.GetDictionary().at(PDFName::Type).GetName() == PDFName::Catalog)
     {
-      pdfObject.AddArrayEntry(ReadObject(in));
-      SkipWhitespace(in);
+      PDFObject::DictionaryEntry root{ PDFName::Root, {} };
+      root.m_value.SetReference(static_cast<PDFObject::Reference>(objectId));
+      m_trailer.SetDictionary(PDFObject::Dictionary{ m_arena.Copy(std::span{ &root, 1 }) });
+      break;
     }
-    GetChar(in);
-    return pdfObject;
   }
-  NotImplemented("\"" + std::string(1, c) + "\"");
-  return PDFObject{};
+
+  return true;
 }
-} // namespace
 
-bool PDFDocument::Load(const std::filesystem::path& path)
+void PDFDocument::SetXRefEntry(std::vector<XRefEntry>& xref, size_t objectId, const XRefEntry& entry)
 {
-  std::ifstream in{ path, std::ios::binary };
-  return Load(in);
+  if (xref[objectId].m_type == XRefEntry::Type::Undefined)
+    xref[objectId] = entry;
 }
 
-bool PDFDocument::Load(std::ifstream& in)
+PDFObject PDFDocument::ParseObject(PDFObject::ID objectId, PDFArena& arena, PDFNameTable& names) const
 {
-  in.seekg(0, std::ios::end);
-  int64_t length{ in.tellg() };
-  int64_t readLength{ std::min<int64_t>(length, 30) };
-  in.seekg(length - readLength, std::ios::beg);
-
-  std::string trailer(readLength, ' ');
-  in.read(trailer.data(), 30);
-  size_t startxrefOffset{ trailer.find("startxref") };
-  if (startxrefOffset == std::string::npos)
-    return false;
+  if (objectId < 0 || static_cast<size_t>(objectId) >= m_xref.size())
+    return PDFObject{};
 
-  while (trailer[startxrefOffset] < '0' || trailer[startxrefOffset] > '9')
-    startxrefOffset++;
-  size_t endxrefOffset{ trailer.find_first_not_of("0123456789", startxrefOffset) };
-  int64_t xrefOffset{ std::stoll(trailer.substr(startxrefOffset, endxrefOffset - startxrefOffset)) };
+  const XRefEntry& entry{ m_xref[objectId] };
+  if (entry.m_type == XRefEntry::Type::Uncompressed)
+    return ParseObjectAt(entry.m_offset, arena, names, objectId);
 
-  in.seekg(xrefOffset + 4, std::ios::beg);
-  int firstObject, objectCount;
-  in >> firstObject >> objectCount;
+  if (entry.m_type == XRefEntry::Type::Compressed)
+  {
+    const ObjectStream& objectStream{ GetObjectStream(entry.m_objectStreamId) };
+    if (entry.m_objectStreamIndex >= objectStream.m_offsets.size())
+      return PDFObject{};
+    PDFParser parser{ objectStream.m_data, objectStream.m_offsets[entry.m_objectStreamIndex] };
+    return parser.ReadObject(arena, names);
+  }
 
-  std::unordered_map<int, int64_t> objectOffsets;
+  return PDFObject{};
+}
 
-  for (int i{ 0 }; i < objectCount; i++)
+PDFObject PDFDocument::ParseObjectAt(size_t offset,
+                                     PDFArena& arena,
+                                     PDFNameTable& names,
+                                     PDFObject::ID expectedObjectId) const
+{
+  PDFParser parser{ m_data, offset };
+
+  PDFObject::ID headerObjectId;
+  if (!parser.ReadObjectHeader(headerObjectId) || (expectedObjectId >= 0 && headerObjectId != expectedObjectId))
+    return PDFObject{};
+
+  PDFObject pdfObject{ parser.ReadObject(arena, names) };
+  parser.SkipWhitespace();
+  if (parser.ReadToken() == "stream" && pdfObject.IsDictionary())
   {
-    int64_t byteOffset;
-    int generationNumber;
-    char usage;
+    parser.SkipEndOfLine();
+    size_t streamOffset{ parser.GetPosition() };
 
-    in >> byteOffset >> generationNumber >> usage;
-    if (usage == 'f')
-      continue;
+    size_t streamLength{ 0 };
+    if (pdfObject.GetDictionary().contains(PDFName::Length))
+    {
+      const PDFObject& streamLengthObject{ Resolve(pdfObject.GetDictionary().at(PDFName::Length)) };
+      if (streamLengthObject.IsInteger() && streamLengthObject.GetInteger() > 0)
+        streamLength = std::min(static_cast<size_t>(streamLengthObject.GetInteger()), m_data.size() - streamOffset);
+    }
+
+    // Repair a wrong or missing /Length, the stream data has to be followed by "endstream"
+    PDFParser endParser{ m_data, streamOffset + streamLength };
+    endParser.SkipWhitespace();
+    if (endParser.ReadToken() != "endstream")
+    {
+      size_t endstreamOffset{ m_data.find("endstream", streamOffset) };
+      if (endstreamOffset != std::string_view::npos)
+      {
+        streamLength = endstreamOffset - streamOffset;
+        if (streamLength > 0 && m_data[streamOffset + streamLength - 1] == '\n')
+          streamLength--;
+        if (streamLength > 0 && m_data[streamOffset + streamLength - 1] == '\r')
+          streamLength--;
+      }
+    }
 
-    objectOffsets.emplace(firstObject + i, byteOffset);
+    pdfObject.SetStream(std::as_bytes(std::span{ m_data.substr(streamOffset, streamLength) }), arena);
   }
 
-  std::unordered_map<int, int64_t> pdfStreams;
+  return pdfObject;
+}
 
-  for (const auto& [objectId, byteOffset] : objectOffsets)
+const PDFDocument::ObjectStream& PDFDocument::GetObjectStream(PDFObject::ID objectId) const
+{
   {
-    in.seekg(byteOffset, std::ios::beg);
+    std::lock_guard lock{ m_objectStreamsMutex };
+    if (auto it{ m_objectStreams.find(objectId) }; it != m_objectStreams.end())
+      return it->second;
+  }
 
-    int _objectId, _generationNumber;
-    std::string _obj;
-    in >> _objectId >> _generationNumber >> _obj;
+  ObjectStream objectStream;
+  // Object streams cannot be stored inside other object streams, checking this also prevents endless recursion
+  if (objectId >= 0 && static_cast<size_t>(objectId) < m_xref.size() &&
+      m_xref[objectId].m_type == XRefEntry::Type::Uncompressed)
+    objectStream = ReadObjectStream(GetObject(objectId));
 
-    PDFObject pdfObject{ ReadObject(in) };
-    // std::cout << "Object " << objectId << ": " << pdfObject << "\n";
-    std::string endobjOrStream;
-    in >> endobjOrStream;
-    if (endobjOrStream == "stream")
-    {
-      while (PeekChar(in) == '\r' || PeekChar(in) == '\n')
-        GetChar(in);
-      pdfStreams[objectId] = in.tellg();
-    }
+  std::lock_guard lock{ m_objectStreamsMutex };
+  return m_objectStreams.try_emplace(objectId, std::move(objectStream)).first->second;
+}
 
-    m_objects[objectId] = pdfObject;
+PDFDocument::ObjectStream PDFDocument::ReadObjectStream(const PDFObject& streamObject)
+{
+  ObjectStream objectStream;
+  if (!streamObject.HasStream() || !streamObject.GetDictionary().contains(PDFName::N) ||
+      !streamObject.GetDictionary().contains(PDFName::First))
+    return objectStream;
+
+  objectStream.m_data = streamObject.GetStream();
+  PDFObject::Integer objectCount{ streamObject.GetDictionary().at(PDFName::N).GetInteger() };
+  PDFObject::Integer first{ streamObject.GetDictionary().at(PDFName::First).GetInteger() };
+
+  // The stream starts with pairs of object ID and offset relative to /First
+  PDFParser parser{ objectStream.m_data };
+  for (PDFObject::Integer i{ 0 }; i < objectCount; i++)
+  {
+    PDFObject::Integer containedObjectId, offset;
+    if (!parser.ReadInteger(containedObjectId) || !parser.ReadInteger(offset))
+      break;
+    objectStream.m_objectIds.push_back(static_cast<PDFObject::ID>(containedObjectId));
+    objectStream.m_offsets.push_back(static_cast<size_t>(first + offset));
   }
+  return objectStream;
+}
 
-  for (const auto& [objectId, streamOffset] : pdfStreams)
+const PDFObject& PDFDocument::GetObject(PDFObject::ID objectId) const
+{
   {
-    PDFObject& pdfObject{ m_objects[objectId] };
+    std::lock_guard lock{ m_objectsMutex };
+    if (auto it{ m_objects.find(objectId) }; it != m_objects.end())
+      return it->second;
+  }
+
+  // The lock is not held while parsing because resolving the length of a stream can request other objects
+  PDFObject pdfObject{ ParseObject(objectId, m_arena, m_names) };
+
+  std::lock_guard lock{ m_objectsMutex };
+  return m_objects.try_emplace(objectId, std::move(pdfObject)).first->second;
+}
+
+const PDFObject& PDFDocument::Resolve(const PDFObject& pdfObject) const
+{
+  return pdfObject.IsReference() ? GetObject(pdfObject.GetReference()) : pdfObject;
+}
+
+std::shared_ptr<const std::string> PDFDocument::GetDecodedStream(PDFObject::ID objectId) const
+{
+  if (auto stream{ m_streamCache.Find(objectId) })
+    return stream;
+
+  // Decoded without holding the cache lock, concurrent misses of the same stream decode it twice but stay correct
+  std::string data;
+  if (!PDFStreamDecoder{ GetObject(objectId) }.ReadAll(data, m_streamCache.GetBudget()))
+    return nullptr;
+  auto stream{ std::make_shared<const std::string>(std::move(data)) };
+  m_streamCache.Insert(objectId, stream);
+  return stream;
+}
 
-    PDFObject streamLengthObject{ pdfObject.GetDictionary().at("Length") };
-    if (streamLengthObject.IsReference())
-      streamLengthObject = m_objects[streamLengthObject.GetReference()];
-    PDFObject::Integer streamLength{ streamLengthObject.GetInteger() };
+void PDFDocument::SetStreamCacheBudget(size_t budget)
+{
+  m_streamCache.SetBudget(budget);
+}
+
+PDFStreamCache::Statistics PDFDocument::GetStreamCacheStatistics() const
+{
+  return m_streamCache.GetStatistics();
+}
 
-    in.seekg(streamOffset, std::ios::beg);
-    PDFObject::Stream objectStream(streamLength);
-    in.read(reinterpret_cast<char*>(objectStream.data()), streamLength);
-    pdfObject.SetStream(objectStream);
+const PDFObject& PDFDocument::GetTrailer() const
+{
+  return m_trailer;
+}
+
+void PDFDocument::ResolveAll() const
+{
+  // Object streams are independent of each other, decompress all of them concurrently before parsing their contents
+  std::vector<PDFObject::ID> objectStreamIds;
+  for (const XRefEntry& entry : m_xref)
+    if (entry.m_type == XRefEntry::Type::Compressed)
+      objectStreamIds.push_back(entry.m_objectStreamId);
+  std::ranges::sort(objectStreamIds);
+  objectStreamIds.erase(std::unique(objectStreamIds.begin(), objectStreamIds.end()), objectStreamIds.end());
+  std::for_each(std::execution::par,
+                objectStreamIds.begin(),
+                objectStreamIds.end(),
+                [this](PDFObject::ID objectStreamId) { GetObjectStream(objectStreamId); });
+
+  std::vector<PDFObject::ID> objectIds;
+  {
+    std::lock_guard lock{ m_objectsMutex };
+    for (size_t objectId{ 0 }; objectId < m_xref.size(); objectId++)
+      if ((m_xref[objectId].m_type == XRefEntry::Type::Uncompressed ||
+           m_xref[objectId].m_type == XRefEntry::Type::Compressed) &&
+          !m_objects.contains(static_cast<PDFObject::ID>(objectId)))
+        objectIds.push_back(static_cast<PDFObject::ID>(objectId));
   }
 
-  return true;
+  // Every xref entry is an independent byte range, so batches of objects are parsed concurrently with their own
+  // cursors and merged into the object table under a single lock afterwards. Each thread allocates from an arena of its
+  // own and looks names up in a table of its own, so the threads only synchronize on names they have not seen yet.
+  struct Worker
+  {
+    PDFArena m_arena;
+    PDFNameTable m_names;
+
+    explicit Worker(PDFNameTable& sharedNames)
+      : m_names(sharedNames)
+    {
+    }
+  };
+  std::mutex workersMutex;
+  std::unordered_map<std::thread::id, Worker> workers;
+
+  constexpr size_t BATCH_SIZE{ 256 };
+  const size_t batchCount{ (objectIds.size() + BATCH_SIZE - 1) / BATCH_SIZE };
+  std::vector<std::vector<std::pair<PDFObject::ID, PDFObject>>> batchObjects(batchCount);
+
+  std::ranges::iota_view batchIndexView{ size_t{ 0 }, batchCount };
+  std::for_each(std::execution::par,
+                batchIndexView.begin(),
+                batchIndexView.end(),
+                [&](size_t batchIndex)
+  {
+    Worker* worker;
+    {
+      std::lock_guard lock{ workersMutex };
+      worker = &workers.try_emplace(std::this_thread::get_id(), m_names).first->second;
+    }
+
+    const size_t batchEnd{ std::min(objectIds.size(), (batchIndex + 1) * BATCH_SIZE) };
+    batchObjects[batchIndex].reserve(batchEnd - batchIndex * BATCH_SIZE);
+    for (size_t i{ batchIndex * BATCH_SIZE }; i < batchEnd; i++)
+      batchObjects[batchIndex].emplace_back(objectIds[i], ParseObject(objectIds[i], worker->m_arena, worker->m_names));
+  });
+
+  for (auto& [threadId, worker] : workers)
+    m_arena.Adopt(worker.m_arena);
+
+  std::lock_guard lock{ m_objectsMutex };
+  m_objects.reserve(m_objects.size() + objectIds.size());
+  for (auto& objects : batchObjects)
+    for (auto& [objectId, pdfObject] : objects)
+      m_objects.try_emplace(objectId, std::move(pdfObject)); // Objects requested meanwhile by another thread are kept
 }
 
 const std::unordered_map<PDFObject::ID, PDFObject>& PDFDocument::GetObjects() const
@@ -1,16 +1,118 @@
 #pragma once
 
+#include "MappedFile.hpp"
+#include "PDFArena.hpp"
+#include "PDFName.hpp"
 #include "PDFObject.hpp"
+#include "PDFStreamCache.hpp"
 #include <filesystem>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
+
+class PDFParser;
 
 class PDFDocument
 {
-  std::unordered_map<PDFObject::ID, PDFObject> m_objects;
+public:
+  enum class LoadMode
+  {
+    Eager, // Parse every object during Load
+    Lazy,  // Parse only the trailer and the xref table during Load, objects are parsed when they are requested
+  };
+
+private:
+  struct XRefEntry
+  {
+    enum class Type
+    {
+      Undefined, // Not listed in any xref section read so far
+      Free,
+      Uncompressed, // Stored directly in the file at m_offset
+      Compressed,   // Stored as entry m_objectStreamIndex of the object stream m_objectStreamId
+    };
+
+    Type m_type{ Type::Undefined };
+    size_t m_offset{ 0 };
+    PDFObject::ID m_objectStreamId{ 0 };
+    size_t m_objectStreamIndex{ 0 };
+  };
+
+  struct ObjectStream
+  {
+    std::string m_data; // Decoded stream, the strings of the objects inside point into this buffer
+    std::vector<PDFObject::ID> m_objectIds;
+    std::vector<size_t> m_offsets;
+  };
+
+  // Names and streams of the parsed objects point into the file data, which is either the memory-mapped file or, for
+  // sources that cannot be mapped, a buffer with a copy of the whole source
+  std::filesystem::path m_path;
+  MappedFile m_mappedFile;
+  std::vector<MappedFile> m_previousMappings; // Kept alive after a reload, unchanged objects still point into them
+  std::string m_buffer;
+  std::string_view m_data;
+
+  std::vector<XRefEntry> m_xref; // Indexed by object ID
+  PDFObject m_trailer;
+  size_t m_xrefOffset{ 0 };
+
+  mutable PDFArena m_arena; // Storage for the arrays, dictionaries and strings of the objects
+  mutable PDFNameTable m_names;
+  mutable std::mutex m_objectsMutex;
+  mutable std::unordered_map<PDFObject::ID, PDFObject> m_objects;
+  mutable std::mutex m_objectStreamsMutex;
+  mutable std::unordered_map<PDFObject::ID, ObjectStream> m_objectStreams;
+  // Object streams replaced by a reload, strings of the unchanged objects which were parsed from them still point into
+  // them
+  std::vector<std::unordered_map<PDFObject::ID, ObjectStream>::node_type> m_previousObjectStreams;
+  mutable PDFStreamCache m_streamCache;
+
+  bool Parse(LoadMode mode);
+  bool ReadXRefOffset(size_t& xrefOffset) const;
+  bool ParseXRefChain(size_t xrefOffset, size_t stopOffset, std::vector<XRefEntry>& xref, PDFObject& trailer) const;
+  bool ParseXRefSection(size_t offset, std::vector<XRefEntry>& xref, PDFObject& trailer) const;
+  bool ParseXRefTable(PDFParser& parser, std::vector<XRefEntry>& xref, PDFObject& trailer) const;
+  bool ParseXRefStream(size_t offset, std::vector<XRefEntry>& xref, PDFObject& trailer) const;
+  static void SetXRefEntry(std::vector<XRefEntry>& xref, size_t objectId, const XRefEntry& entry);
+  bool ReconstructXRef();
+  // The arena and the name table are those of the document unless the object is parsed by a worker of ResolveAll
+  PDFObject ParseObject(PDFObject::ID objectId, PDFArena& arena, PDFNameTable& names) const;
+  PDFObject ParseObjectAt(size_t offset,
+                          PDFArena& arena,
+                          PDFNameTable& names,
+                          PDFObject::ID expectedObjectId = -1) const;
+  const ObjectStream& GetObjectStream(PDFObject::ID objectId) const;
+  static ObjectStream ReadObjectStream(const PDFObject& streamObject);
 
 public:
-  bool Load(const std::filesystem::path& path);
-  bool Load(std::ifstream& stream);
+  PDFDocument() = default;
+  PDFDocument(const PDFDocument&) = delete;
+  PDFDocument& operator=(const PDFDocument&) = delete;
+
+  bool Load(const std::filesystem::path& path, LoadMode mode = LoadMode::Eager);
+  bool Load(std::istream& stream, LoadMode mode = LoadMode::Eager);
+  // Reads only the xref sections of an incremental update which was appended to the file since it was loaded. The
+  // memoized versions of the changed objects are discarded, references to them become invalid. Returns false if the
+  // file did not just grow by an update, in which case it needs to be loaded again.
+  bool Reload(std::vector<PDFObject::ID>& changedObjectIds);
+
+  // Parses the object on first use, the returned reference stays valid for the lifetime of the document
+  const PDFObject& GetObject(PDFObject::ID objectId) const;
+  // Returns the referenced object for references and the object itself otherwise
+  const PDFObject& Resolve(const PDFObject& pdfObject) const;
+  // Decodes the stream of the object on first use, recently used streams are kept in a cache with a byte budget.
+  // Returns nullptr for a stream which decodes to more than the whole budget, it is read with a PDFStreamDecoder.
+  std::shared_ptr<const std::string> GetDecodedStream(PDFObject::ID objectId) const;
+  void SetStreamCacheBudget(size_t budget);
+  PDFStreamCache::Statistics GetStreamCacheStatistics() const;
+  const PDFObject& GetTrailer() const;
+  void ResolveAll() const;
 
+  // Contains only the objects which were resolved so far, which are all objects after an eager load
   const std::unordered_map<PDFObject::ID, PDFObject>& GetObjects() const;
 };
@@ -0,0 +1,678 @@
+#include "PDFFilter.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <vector>
+#include <zlib.h>
+
+namespace
+{
+// Input of a filter, which is either the raw stream data or the output of the previous filter
+class FilterInput
+{
+  std::unique_ptr<PDFFilter> m_source;
+  std::vector<char> m_buffer;
+  const char* m_position{ nullptr };
+  const char* m_end{ nullptr };
+
+public:
+  explicit FilterInput(PDFObject::Stream data)
+    : m_position(reinterpret_cast<const char*>(data.data()))
+    , m_end(m_position + data.size())
+  {
+  }
+
+  explicit FilterInput(std::unique_ptr<PDFFilter> source)
+    : m_source(std::move(source))
+    , m_buffer(PDFFilter::CHUNK_SIZE)
+  {
+  }
+
+  // Returns the unread part of the current chunk, which is only empty at the end of the data
+  std::string_view Peek()
+  {
+    if (m_position == m_end && m_source)
+    {
+      m_position = m_buffer.data();
+      m_end = m_position + m_source->Read(m_buffer.data(), m_buffer.size());
+    }
+    return { m_position, static_cast<size_t>(m_end - m_position) };
+  }
+
+  void Consume(size_t count) { m_position += count; }
+
+  // Returns -1 at the end of the data
+  int GetByte()
+  {
+    if (Peek().empty())
+      return -1;
+    return static_cast<unsigned char>(*m_position++);
+  }
+};
+
+class RawFilter : public PDFFilter
+{
+  FilterInput m_input;
+
+public:
+  explicit RawFilter(FilterInput&& input)
+    : m_input(std::move(input))
+  {
+  }
+
+  size_t Read(char* buffer, size_t size) override
+  {
+    std::string_view input{ m_input.Peek() };
+    size_t count{ std::min(size, input.size()) };
+    std::memcpy(buffer, input.data(), count);
+    m_input.Consume(count);
+    return count;
+  }
+};
+
+class FlateFilter : public PDFFilter
+{
+  FilterInput m_input;
+  z_stream m_stream{};
+  bool m_finished{ false };
+
+public:
+  explicit FlateFilter(FilterInput&& input)
+    : m_input(std::move(input))
+  {
+    m_finished = inflateInit(&m_stream) != Z_OK;
+  }
+
+  ~FlateFilter() override { inflateEnd(&m_stream); }
+
+  size_t Read(char* buffer, size_t size) override
+  {
+    m_stream.next_out = reinterpret_cast<Bytef*>(buffer);
+    m_stream.avail_out = static_cast<uInt>(std::min<size_t>(size, std::numeric_limits<uInt>::max()));
+    const uInt outputSize{ m_stream.avail_out };
+
+    while (m_stream.avail_out > 0 && !m_finished)
+    {
+      std::string_view input{ m_input.Peek() };
+      m_stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+      m_stream.avail_in = static_cast<uInt>(std::min<size_t>(input.size(), std::numeric_limits<uInt>::max()));
+      const uInt availableOutput{ m_stream.avail_out };
+      int ret{ inflate(&m_stream, Z_NO_FLUSH) };
+      m_input.Consume(static_cast<size_t>(reinterpret_cast<const char*>(m_stream.next_in) - input.data()));
+      // Truncated or corrupted data ends the stream, keeping what could be decoded
+      if (ret == Z_STREAM_END || (ret != Z_OK && ret != Z_BUF_ERROR) ||
+          (input.empty() && m_stream.avail_out == availableOutput))
+        m_finished = true;
+    }
+
+    return outputSize - m_stream.avail_out;
+  }
+};
+
+class ASCIIHexFilter : public PDFFilter
+{
+  FilterInput m_input;
+  char m_upperNibble{ 0 };
+  bool m_hasUpperNibble{ false };
+  bool m_finished{ false };
+
+  static int ConvertNibble(int c)
+  {
+    if (c >= '0' && c <= '9')
+      return c - '0';
+    if (c >= 'a' && c <= 'f')
+      return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+      return c - 'A' + 10;
+    return -1;
+  }
+
+public:
+  explicit ASCIIHexFilter(FilterInput&& input)
+    : m_input(std::move(input))
+  {
+  }
+
+  size_t Read(char* buffer, size_t size) override
+  {
+    size_t written{ 0 };
+    while (written < size && !m_finished)
+    {
+      int c{ m_input.GetByte() };
+      if (c < 0 || c == '>')
+      {
+        // A missing final digit is treated as 0
+        if (m_hasUpperNibble)
+          buffer[written++] = static_cast<char>(m_upperNibble << 4);
+        m_finished = true;
+        break;
+      }
+
+      int nibble{ ConvertNibble(c) };
+      if (nibble < 0) // Whitespace
+        continue;
+      if (m_hasUpperNibble)
+        buffer[written++] = static_cast<char>((m_upperNibble << 4) | nibble);
+      else
+        m_upperNibble = static_cast<char>(nibble);
+      m_hasUpperNibble = !m_hasUpperNibble;
+    }
+    return written;
+  }
+};
+
+class ASCII85Filter : public PDFFilter
+{
+  FilterInput m_input;
+  uint64_t m_group{ 0 };
+  int m_groupLength{ 0 };
+  std::array<char, 4> m_pending{};
+  int m_pendingPosition{ 0 };
+  int m_pendingSize{ 0 };
+  bool m_finished{ false };
+
+  void SetPending(uint64_t group, int size)
+  {
+    for (int i{ 0 }; i < 4; i++)
+      m_pending[i] = static_cast<char>(group >> (24 - 8 * i));
+    m_pendingPosition = 0;
+    m_pendingSize = size;
+  }
+
+public:
+  explicit ASCII85Filter(FilterInput&& input)
+    : m_input(std::move(input))
+  {
+  }
+
+  size_t Read(char* buffer, size_t size) override
+  {
+    size_t written{ 0 };
+    while (written < size)
+    {
+      if (m_pendingPosition < m_pendingSize)
+      {
+        buffer[written++] = m_pending[m_pendingPosition++];
+        continue;
+      }
+      if (m_finished)
+        break;
+
+      int c{ m_input.GetByte() };
+      if (c < 0 || c == '~')
+      {
+        // A final group of n characters is padded with the highest digit and yields n - 1 bytes
+        if (m_groupLength > 1)
+        {
+          for (int i{ m_groupLength }; i < 5; i++)
+            m_group = m_group * 85 + 84;
+          SetPending(m_group, m_groupLength - 1);
+        }
+        m_finished = true;
+      }
+      else if (c == 'z' && m_groupLength == 0)
+        SetPending(0, 4);
+      else if (c >= '!' && c <= 'u')
+      {
+        m_group = m_group * 85 + static_cast<uint64_t>(c - '!');
+        if (++m_groupLength == 5)
+        {
+          SetPending(m_group, 4);
+          m_group = 0;
+          m_groupLength = 0;
+        }
+      }
+    }
+    return written;
+  }
+};
+
+class LZWFilter : public PDFFilter
+{
+  static constexpr int CLEAR_TABLE{ 256 };
+  static constexpr int END_OF_DATA{ 257 };
+  static constexpr int FIRST_CODE{ 258 };
+  static constexpr int MAX_CODES{ 4096 };
+
+  struct Entry
+  {
+    uint16_t m_prefix;
+    uint16_t m_length;
+    char m_byte;
+    char m_firstByte;
+  };
+
+  FilterInput m_input;
+  int m_earlyChange;
+  std::vector<Entry> m_table;
+  int m_nextCode{ FIRST_CODE };
+  int m_previousCode{ -1 };
+  uint32_t m_bitBuffer{ 0 };
+  int m_bitCount{ 0 };
+  std::array<char, MAX_CODES> m_pending{};
+  size_t m_pendingPosition{ 0 };
+  size_t m_pendingSize{ 0 };
+  bool m_finished{ false };
+
+  int ReadCode()
+  {
+    int codeLength{ 9 };
+    if (m_nextCode + m_earlyChange >= 2048)
+      codeLength = 12;
+    else if (m_nextCode + m_earlyChange >= 1024)
+      codeLength = 11;
+    else if (m_nextCode + m_earlyChange >= 512)
+      codeLength = 10;
+
+    while (m_bitCount < codeLength)
+    {
+      int c{ m_input.GetByte() };
+      if (c < 0)
+        return -1;
+      m_bitBuffer = (m_bitBuffer << 8) | static_cast<uint32_t>(c);
+      m_bitCount += 8;
+    }
+    m_bitCount -= codeLength;
+    return static_cast<int>((m_bitBuffer >> m_bitCount) & ((1u << codeLength) - 1));
+  }
+
+  // Entries are stored as their prefix code and last byte, so they are written back to front
+  void SetPending(int code, char lastByte, bool appendLastByte)
+  {
+    m_pendingSize = m_table[code].m_length + (appendLastByte ? 1 : 0);
+    size_t position{ m_pendingSize };
+    if (appendLastByte)
+      m_pending[--position] = lastByte;
+    while (position > 0)
+    {
+      m_pending[--position] = m_table[code].m_byte;
+      code = m_table[code].m_prefix;
+    }
+    m_pendingPosition = 0;
+  }
+
+public:
+  LZWFilter(FilterInput&& input, int earlyChange)
+    : m_input(std::move(input))
+    , m_earlyChange(earlyChange)
+    , m_table(MAX_CODES)
+  {
+    for (int i{ 0 }; i < 256; i++)
+      m_table[i] = { 0, 1, static_cast<char>(i), static_cast<char>(i) };
+  }
+
+  size_t Read(char* buffer, size_t size) override
+  {
+    size_t written{ 0 };
+    while (written < size)
+    {
+      if (m_pendingPosition < m_pendingSize)
+      {
+        size_t count{ std::min(size - written, m_pendingSize - m_pendingPosition) };
+        std::memcpy(buffer + written, m_pending.data() + m_pendingPosition, count);
+        written += count;
+        m_pendingPosition += count;
+        continue;
+      }
+      if (m_finished)
+        break;
+
+      int code{ ReadCode() };
+      if (code < 0 || code == END_OF_DATA)
+      {
+        m_finished = true;
+        continue;
+      }
+      if (code == CLEAR_TABLE)
+      {
+        m_nextCode = FIRST_CODE;
+        m_previousCode = -1;
+        continue;
+      }
+
+      if (m_previousCode < 0)
+      {
+        if (code >= FIRST_CODE)
+        {
+          m_finished = true;
+          continue;
+        }
+        SetPending(code, 0, false);
+        m_previousCode = code;
+        continue;
+      }
+
+      char firstByte;
+      if (code < m_nextCode)
+      {
+        SetPending(code, 0, false);
+        firstByte = m_table[code].m_firstByte;
+      }
+      else if (code == m_nextCode)
+      {
+        // The code which is about to be defined, it repeats the previous entry followed by its own first byte
+        firstByte = m_table[m_previousCode].m_firstByte;
+        SetPending(m_previousCode, firstByte, true);
+      }
+      else
+      {
+        m_finished = true;
+        continue;
+      }
+
+      if (m_nextCode < MAX_CODES)
+      {
+        m_table[m_nextCode] = { static_cast<uint16_t>(m_previousCode),
+                                static_cast<uint16_t>(m_table[m_previousCode].m_length + 1),
+                                firstByte,
+                                m_table[m_previousCode].m_firstByte };
+        m_nextCode++;
+      }
+      m_previousCode = code;
+    }
+    return written;
+  }
+};
+
+class RunLengthFilter : public PDFFilter
+{
+  FilterInput m_input;
+  size_t m_literalRemaining{ 0 };
+  size_t m_repeatRemaining{ 0 };
+  char m_repeatByte{ 0 };
+  bool m_finished{ false };
+
+public:
+  explicit RunLengthFilter(FilterInput&& input)
+    : m_input(std::move(input))
+  {
+  }
+
+  size_t Read(char* buffer, size_t size) override
+  {
+    size_t written{ 0 };
+    while (written < size)
+    {
+      if (m_literalRemaining > 0)
+      {
+        std::string_view input{ m_input.Peek() };
+        if (input.empty())
+        {
+          m_literalRemaining = 0;
+          m_finished = true;
+          continue;
+        }
+        size_t count{ std::min({ m_literalRemaining, size - written, input.size() }) };
+        std::memcpy(buffer + written, input.data(), count);
+        m_input.Consume(count);
+        written += count;
+        m_literalRemaining -= count;
+        continue;
+      }
+      if (m_repeatRemaining > 0)
+      {
+        size_t count{ std::min(m_repeatRemaining, size - written) };
+        std::memset(buffer + written, m_repeatByte, count);
+        written += count;
+        m_repeatRemaining -= count;
+        continue;
+      }
+      if (m_finished)
+        break;
+
+      // 0-127 copies the next length + 1 bytes, 129-255 repeats the next byte 257 - length times, 128 ends the data
+      int length{ m_input.GetByte() };
+      if (length < 0 || length == 128)
+        m_finished = true;
+      else if (length < 128)
+        m_literalRemaining = static_cast<size_t>(length) + 1;
+      else
+      {
+        int c{ m_input.GetByte() };
+        if (c < 0)
+          m_finished = true;
+        else
+        {
+          m_repeatByte = static_cast<char>(c);
+          m_repeatRemaining = static_cast<size_t>(257 - length);
+        }
+      }
+    }
+    return written;
+  }
+};
+
+// Reverses the TIFF (2) and PNG (>= 10) predictors of Flate and LZW encoded data row by row
+class PredictorFilter : public PDFFilter
+{
+  FilterInput m_input;
+  int m_predictor;
+  size_t m_bytesPerPixel;
+  size_t m_bitsPerComponent;
+  std::vector<unsigned char> m_encodedRow;
+  std::vector<unsigned char> m_row;
+  std::vector<unsigned char> m_previousRow;
+  size_t m_rowPosition{ 0 };
+
+  bool ReadRow()
+  {
+    // PNG rows start with a byte selecting the filter type
+    size_t rowSize{ m_row.size() + (m_predictor >= 10 ? 1 : 0) };
+    m_encodedRow.resize(rowSize);
+    for (size_t position{ 0 }; position < rowSize;)
+    {
+      std::string_view input{ m_input.Peek() };
+      if (input.empty())
+        return false;
+      size_t count{ std::min(rowSize - position, input.size()) };
+      std::memcpy(m_encodedRow.data() + position, input.data(), count);
+      m_input.Consume(count);
+      position += count;
+    }
+
+    std::swap(m_row, m_previousRow);
+    if (m_predictor == 2)
+    {
+      std::copy(m_encodedRow.begin(), m_encodedRow.end(), m_row.begin());
+      if (m_bitsPerComponent == 8)
+        for (size_t i{ m_bytesPerPixel }; i < m_row.size(); i++)
+          m_row[i] = static_cast<unsigned char>(m_row[i] + m_row[i - m_bytesPerPixel]);
+      return true;
+    }
+
+    const unsigned char filterType{ m_encodedRow[0] };
+    for (size_t i{ 0 }; i < m_row.size(); i++)
+    {
+      int raw{ m_encodedRow[i + 1] };
+      int left{ i >= m_bytesPerPixel ? m_row[i - m_bytesPerPixel] : 0 };
+      int up{ m_previousRow[i] };
+      int upLeft{ i >= m_bytesPerPixel ? m_previousRow[i - m_bytesPerPixel] : 0 };
+
+      int predicted{ 0 };
+      switch (filterType)
+      {
+        case 1:
+          predicted = left;
+          break;
+        case 2:
+          predicted = up;
+          break;
+        case 3:
+          predicted = (left + up) / 2;
+          break;
+        case 4:
+        {
+          int p{ left + up - upLeft };
+          int pLeft{ std::abs(p - left) };
+          int pUp{ std::abs(p - up) };
+          int pUpLeft{ std::abs(p - upLeft) };
+          predicted = (pLeft <= pUp && pLeft <= pUpLeft) ? left : (pUp <= pUpLeft ? up : upLeft);
+          break;
+        }
+        default:
+          break;
+      }
+      m_row[i] = static_cast<unsigned char>(raw + predicted);
+    }
+    return true;
+  }
+
+public:
+  PredictorFilter(FilterInput&& input, int predictor, size_t rowSize, size_t colors, size_t bitsPerComponent)
+    : m_input(std::move(input))
+    , m_predictor(predictor)
+    , m_bytesPerPixel(std::max<size_t>(1, colors * bitsPerComponent / 8))
+    , m_bitsPerComponent(bitsPerComponent)
+    , m_row(rowSize, 0)
+    , m_previousRow(m_row.size(), 0)
+    , m_rowPosition(m_row.size())
+  {
+  }
+
+  size_t Read(char* buffer, size_t size) override
+  {
+    size_t written{ 0 };
+    while (written < size)
+    {
+      if (m_rowPosition == m_row.size())
+      {
+        if (!ReadRow())
+          break;
+        m_rowPosition = 0;
+      }
+      size_t count{ std::min(size - written, m_row.size() - m_rowPosition) };
+      std::memcpy(buffer + written, m_row.data() + m_rowPosition, count);
+      written += count;
+      m_rowPosition += count;
+    }
+    return written;
+  }
+};
+
+bool IsSupportedFilter(PDFObject::Name filterName)
+{
+  return filterName == PDFName::FlateDecode || filterName == PDFName::LZWDecode ||
+         filterName == PDFName::ASCIIHexDecode || filterName == PDFName::ASCII85Decode ||
+         filterName == PDFName::RunLengthDecode;
+}
+
+std::unique_ptr<PDFFilter> CreateFilter(PDFObject::Name filterName,
+                                        const PDFObject& decodeParms,
+                                        size_t encodedSize,
+                                        FilterInput&& input)
+{
+  const PDFObject::Dictionary parameters{ decodeParms.GetDictionary() };
+  auto GetParameter{ [&](PDFObject::Name name, PDFObject::Integer defaultValue)
+  { return parameters.contains(name) ? parameters.at(name).GetInteger() : defaultValue; } };
+
+  std::unique_ptr<PDFFilter> filter;
+  if (filterName == PDFName::FlateDecode)
+    filter = std::make_unique<FlateFilter>(std::move(input));
+  else if (filterName == PDFName::LZWDecode)
+    filter = std::make_unique<LZWFilter>(std::move(input), static_cast<int>(GetParameter(PDFName::EarlyChange, 1)));
+  else if (filterName == PDFName::ASCIIHexDecode)
+    return std::make_unique<ASCIIHexFilter>(std::move(input));
+  else if (filterName == PDFName::ASCII85Decode)
+    return std::make_unique<ASCII85Filter>(std::move(input));
+  else
+    return std::make_unique<RunLengthFilter>(std::move(input));
+
+  PDFObject::Integer predictor{ GetParameter(PDFName::Predictor, 1) };
+  if (predictor != 2 && predictor < 10)
+    return filter;
+
+  // Clamped to the ranges of the specification, which keeps the row size from overflowing
+  const size_t colors{ static_cast<size_t>(std::clamp<PDFObject::Integer>(GetParameter(PDFName::Colors, 1), 1, 32)) };
+  const size_t bitsPerComponent{ static_cast<size_t>(
+    std::clamp<PDFObject::Integer>(GetParameter(PDFName::BitsPerComponent, 8), 1, 16)) };
+  const size_t columns{ static_cast<size_t>(
+    std::clamp<PDFObject::Integer>(GetParameter(PDFName::Columns, 1), 1, std::numeric_limits<int32_t>::max())) };
+  const size_t rowSize{ (colors * bitsPerComponent * columns + 7) / 8 };
+
+  // Neither Flate nor LZW expand a byte to more than 4096 bytes, so not even a single row of such a size could be
+  // decoded. The data is passed on without reversing the predictor instead of allocating the row.
+  if (rowSize > encodedSize * 4096 + 1024)
+    return filter;
+  return std::make_unique<PredictorFilter>(FilterInput{ std::move(filter) },
+                                           static_cast<int>(std::min<PDFObject::Integer>(predictor, 15)),
+                                           rowSize,
+                                           colors,
+                                           bitsPerComponent);
+}
+} // namespace
+
+PDFStreamDecoder::PDFStreamDecoder(const PDFObject& streamObject)
+{
+  const PDFObject::Stream rawStream{ streamObject.GetRawStream() };
+  const PDFObject::Dictionary dictionary{ streamObject.GetDictionary() };
+  const PDFObject& filter{ dictionary.at(PDFName::Filter) };
+  const PDFObject& decodeParms{ dictionary.at(PDFName::DecodeParms) };
+
+  // /Filter and /DecodeParms are either single entries or arrays of the same length
+  std::span<const PDFObject> filterNames{ filter.IsArray() ? filter.GetArray() : std::span{ &filter, 1 } };
+  std::span<const PDFObject> filterParameters{ decodeParms.IsArray() ? decodeParms.GetArray()
+                                                                     : std::span{ &decodeParms, 1 } };
+
+  for (size_t i{ 0 }; i < filterNames.size() && IsSupportedFilter(filterNames[i].GetName()); i++)
+  {
+    static const PDFObject nullObject;
+    FilterInput input{ m_output ? FilterInput{ std::move(m_output) } : FilterInput{ rawStream } };
+    m_output = CreateFilter(filterNames[i].GetName(),
+                            i < filterParameters.size() ? filterParameters[i] : nullObject,
+                            rawStream.size(),
+                            std::move(input));
+  }
+
+  if (!m_output)
+  {
+    m_output = std::make_unique<RawFilter>(FilterInput{ rawStream });
+    m_sizeHint = rawStream.size();
+    return;
+  }
+
+  // Deflate cannot compress more than 1032:1, which limits the allocation for a bogus /DL
+  m_sizeHint = std::max<size_t>(rawStream.size() * 4, 1024);
+  if (PDFObject::Integer decodedLength{ dictionary.at(PDFName::DL).GetInteger() }; decodedLength > 0)
+    m_sizeHint = std::min(static_cast<size_t>(decodedLength), rawStream.size() * 1032 + 1024);
+}
+
+size_t PDFStreamDecoder::Read(char* buffer, size_t size)
+{
+  return m_output->Read(buffer, size);
+}
+
+bool PDFStreamDecoder::ReadAll(std::string& data, size_t maxSize)
+{
+  data.assign(std::min(m_sizeHint, maxSize), '\0');
+  size_t size{ 0 };
+  while (true)
+  {
+    if (size == data.size())
+    {
+      // Probe before growing, an exact size hint should not double the buffer
+      std::array<char, 256> probe;
+      size_t probeSize{ Read(probe.data(), probe.size()) };
+      if (probeSize == 0)
+        break;
+      if (probeSize > maxSize - size)
+      {
+        data = {};
+        return false;
+      }
+      data.resize(std::min(std::max<size_t>(data.size() * 2, 1024), maxSize));
+      std::memcpy(data.data() + size, probe.data(), probeSize);
+      size += probeSize;
+    }
+
+    size_t readSize{ Read(data.data() + size, data.size() - size) };
+    if (readSize == 0)
+      break;
+    size += readSize;
+  }
+  // The buffer is kept by the stream cache, which only counts the decoded size
+  data.resize(size);
+  data.shrink_to_fit();
+  return true;
+}
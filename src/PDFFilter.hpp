@@ -0,0 +1,35 @@
+#pragma once
+
+#include "PDFObject.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Stage of a stream decoding pipeline. Stages pull their input from the previous stage in chunks, so only about one
+// chunk per stage is held in memory no matter how large the stream is.
+class PDFFilter
+{
+public:
+  static constexpr size_t CHUNK_SIZE{ 16 << 10 };
+
+  virtual ~PDFFilter() = default;
+  // Writes up to size decoded bytes to buffer and returns how many were written, which is only 0 at the end of the data
+  virtual size_t Read(char* buffer, size_t size) = 0;
+};
+
+// Decodes the payload of a stream object with the chain of filters listed in its /Filter entry. Filters which are not
+// supported, like the image codecs, end the chain and leave their data encoded.
+class PDFStreamDecoder
+{
+  std::unique_ptr<PDFFilter> m_output;
+  size_t m_sizeHint{ 0 };
+
+public:
+  explicit PDFStreamDecoder(const PDFObject& streamObject);
+
+  // Writes up to size decoded bytes to buffer and returns how many were written, which is only 0 at the end of the data
+  size_t Read(char* buffer, size_t size);
+  // Decodes everything into a single buffer presized from /DL or the size of the raw data. Returns false and an empty
+  // buffer if the stream decodes to more than maxSize bytes.
+  bool ReadAll(std::string& data, size_t maxSize = SIZE_MAX);
+};
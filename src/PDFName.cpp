@@ -0,0 +1,59 @@
+#include "PDFName.hpp"
+#include <array>
+#include <mutex>
+#include <new>
+
+namespace
+{
+#define PDF_LIST_NAME(name) PDFName::name,
+constexpr std::array PREDEFINED_NAMES{ PDF_PREDEFINED_NAMES(PDF_LIST_NAME) };
+#undef PDF_LIST_NAME
+} // namespace
+
+PDFName PDFNameTable::Intern(std::string_view string)
+{
+  // Most names are predefined, they are found without taking the lock
+  static const std::unordered_map<std::string_view, PDFName> predefinedNames{ []()
+  {
+    std::unordered_map<std::string_view, PDFName> names;
+    for (PDFName name : PREDEFINED_NAMES)
+      names.emplace(name.GetString(), name);
+    return names;
+  }() };
+  if (auto it{ predefinedNames.find(string) }; it != predefinedNames.end())
+    return it->second;
+
+  if (m_sharedTable != nullptr)
+  {
+    if (auto it{ m_names.find(string) }; it != m_names.end())
+      return it->second;
+    PDFName name{ m_sharedTable->Intern(string) };
+    m_names.emplace(name.GetString(), name);
+    return name;
+  }
+
+  {
+    std::shared_lock lock{ m_mutex };
+    if (auto it{ m_names.find(string) }; it != m_names.end())
+      return it->second;
+  }
+
+  std::unique_lock lock{ m_mutex };
+  if (auto it{ m_names.find(string) }; it != m_names.end())
+    return it->second;
+
+  // The characters are copied as the names of object streams point into buffers which do not live as long as the table
+  std::string_view storedCharacters{ m_storage.Copy(std::span{ string }).data(), string.size() };
+  auto* storedString{ new (m_storage.Allocate(sizeof(std::string_view), alignof(std::string_view)))
+                        std::string_view{ storedCharacters } };
+  PDFName name{ storedString };
+  m_names.emplace(*storedString, name);
+  return name;
+}
+
+void PDFNameTable::Clear()
+{
+  std::unique_lock lock{ m_mutex };
+  m_names.clear();
+  m_storage.Clear();
+}
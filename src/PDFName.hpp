@@ -0,0 +1,114 @@
+#pragma once
+
+#include "PDFArena.hpp"
+#include <compare>
+#include <functional>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+
+// Names which are looked up by the code, every name table knows them so they can be used as compile-time constants
+#define PDF_PREDEFINED_NAMES(X)                                                                                        \
+  X(ASCII85Decode)                                                                                                     \
+  X(ASCIIHexDecode)                                                                                                    \
+  X(BBox)                                                                                                              \
+  X(BitsPerComponent)                                                                                                  \
+  X(Catalog)                                                                                                           \
+  X(Colors)                                                                                                            \
+  X(Columns)                                                                                                           \
+  X(Contents)                                                                                                          \
+  X(Count)                                                                                                             \
+  X(CropBox)                                                                                                           \
+  X(DL)                                                                                                                \
+  X(DecodeParms)                                                                                                       \
+  X(EarlyChange)                                                                                                       \
+  X(Filter)                                                                                                            \
+  X(First)                                                                                                             \
+  X(FlateDecode)                                                                                                       \
+  X(Form)                                                                                                              \
+  X(Index)                                                                                                             \
+  X(Kids)                                                                                                              \
+  X(LZWDecode)                                                                                                         \
+  X(Length)                                                                                                            \
+  X(Matrix)                                                                                                            \
+  X(MediaBox)                                                                                                          \
+  X(N)                                                                                                                 \
+  X(ObjStm)                                                                                                            \
+  X(Page)                                                                                                              \
+  X(Pages)                                                                                                             \
+  X(Parent)                                                                                                            \
+  X(Predictor)                                                                                                         \
+  X(Prev)                                                                                                              \
+  X(Resources)                                                                                                         \
+  X(Root)                                                                                                              \
+  X(Rotate)                                                                                                            \
+  X(RunLengthDecode)                                                                                                   \
+  X(Size)                                                                                                              \
+  X(Subtype)                                                                                                           \
+  X(Type)                                                                                                              \
+  X(W)                                                                                                                 \
+  X(XObject)                                                                                                           \
+  X(XRef)                                                                                                              \
+  X(XRefStm)
+
+// Interned name, equal names share their storage so comparing names only compares addresses. The order of names is
+// the order of their storage and not alphabetical.
+class PDFName
+{
+  friend class PDFObject;
+
+  const std::string_view* m_string{ nullptr };
+
+public:
+  constexpr PDFName() = default;
+  constexpr explicit PDFName(const std::string_view* string)
+    : m_string(string)
+  {
+  }
+
+  std::string_view GetString() const { return m_string != nullptr ? *m_string : std::string_view{}; }
+
+  bool operator==(const PDFName& other) const = default;
+  std::strong_ordering operator<=>(const PDFName& other) const
+  {
+    return std::compare_three_way{}(m_string, other.m_string);
+  }
+
+#define PDF_DECLARE_NAME(name) static const PDFName name;
+  PDF_PREDEFINED_NAMES(PDF_DECLARE_NAME)
+#undef PDF_DECLARE_NAME
+};
+
+namespace PDFNameStrings
+{
+#define PDF_DEFINE_NAME_STRING(name) inline constexpr std::string_view name{ #name };
+PDF_PREDEFINED_NAMES(PDF_DEFINE_NAME_STRING)
+#undef PDF_DEFINE_NAME_STRING
+} // namespace PDFNameStrings
+
+#define PDF_DEFINE_NAME(name) inline constexpr PDFName PDFName::name{ &PDFNameStrings::name };
+PDF_PREDEFINED_NAMES(PDF_DEFINE_NAME)
+#undef PDF_DEFINE_NAME
+
+// Interns the names of a document, lookups may run concurrently
+class PDFNameTable
+{
+  mutable std::shared_mutex m_mutex;
+  std::unordered_map<std::string_view, PDFName> m_names;
+  PDFArena m_storage;
+  PDFNameTable* m_sharedTable{ nullptr };
+
+public:
+  PDFNameTable() = default;
+  // Table of a single thread, names are interned in the shared table on first use and found without locking afterwards
+  explicit PDFNameTable(PDFNameTable& sharedTable)
+    : m_sharedTable(&sharedTable)
+  {
+  }
+  PDFNameTable(const PDFNameTable&) = delete;
+  PDFNameTable& operator=(const PDFNameTable&) = delete;
+
+  PDFName Intern(std::string_view string);
+  // Invalidates all names except the predefined ones
+  void Clear();
+};
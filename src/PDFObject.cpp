@@ -1,12 +1,15 @@
 #include "PDFObject.hpp"
-#include <array>
-#include <cstring>
+#include "PDFArena.hpp"
+#include "PDFFilter.hpp"
+#include <algorithm>
 #include <ostream>
-#include <zlib.h>
+#include <type_traits>
+
+static_assert(std::is_trivially_copyable_v<PDFObject> && sizeof(PDFObject) <= 24);
 
 void PDFObject::SetNull()
 {
-  m_type = Type::Null;
+  *this = PDFObject{};
 }
 
 void PDFObject::SetBoolean(PDFObject::Boolean boolean)
@@ -27,71 +30,64 @@ void PDFObject::SetDecimal(PDFObject::Decimal decimal)
   m_decimal = decimal;
 }
 
-void PDFObject::SetName(const PDFObject::Name& name)
+void PDFObject::SetName(PDFObject::Name name)
 {
   m_type = Type::Name;
-  m_name = name;
+  m_name = name.m_string;
 }
 
-void PDFObject::SetString(const PDFObject::String& string)
+void PDFObject::SetString(PDFObject::String string)
 {
   m_type = Type::String;
-  m_string = string;
+  m_characters = string.data();
+  m_size = static_cast<uint32_t>(string.size());
 }
 
-void PDFObject::AddArrayEntry(const PDFObject& pdfObject)
+void PDFObject::SetArray(PDFObject::Array array)
 {
   m_type = Type::Array;
-  m_array.push_back(pdfObject);
+  m_array = array.data();
+  m_size = static_cast<uint32_t>(array.size());
 }
 
-void PDFObject::AddDictionaryEntry(const PDFObject::Name& name, const PDFObject& pdfObject)
+void PDFObject::SetDictionary(const PDFObject::Dictionary& dictionary)
 {
   m_type = Type::Dictionary;
-  m_dictionary[name] = pdfObject;
+  m_dictionary = dictionary.begin() == dictionary.end() ? nullptr : &*dictionary.begin();
+  m_size = static_cast<uint32_t>(dictionary.size());
 }
 
-void PDFObject::SetReference(const PDFObject::Reference& reference)
+void PDFObject::SetReference(PDFObject::Reference reference)
 {
   m_type = Type::Reference;
   m_reference = reference;
 }
 
-void PDFObject::SetStream(const PDFObject::Stream& stream)
+void PDFObject::SetStream(PDFObject::Stream stream, PDFArena& arena)
 {
-  m_hasStream = true;
-  m_stream = stream;
+  m_stream = arena.Copy(std::span{ &stream, 1 }).data();
 }
 
-std::string PDFObject::GetStream() const
+const PDFObject* PDFObject::Dictionary::find(PDFObject::Name key) const
 {
-  // TODO: What about other filters?
-
-  z_stream zs;
-  std::memset(&zs, 0, sizeof(zs));
-  inflateInit(&zs);
-  zs.next_in = reinterpret_cast<Bytef*>(const_cast<std::byte*>(m_stream.data()));
-  zs.avail_in = static_cast<uInt>(m_stream.size());
-
-  std::array<std::byte, 1024> tempBuffer;
-  PDFObject::Stream streambuffer;
+  auto entry{ std::ranges::lower_bound(m_entries, key, {}, &DictionaryEntry::m_key) };
+  return entry != m_entries.end() && entry->m_key == key ? &entry->m_value : nullptr;
+}
 
-  int ret;
-  do
-  {
-    zs.next_out = reinterpret_cast<Bytef*>(tempBuffer.data());
-    zs.avail_out = static_cast<uInt>(tempBuffer.size());
-    ret = inflate(&zs, 0);
-    if (zs.total_out > streambuffer.size())
-      streambuffer.insert(streambuffer.end(),
-                          tempBuffer.begin(),
-                          tempBuffer.begin() + (zs.total_out - static_cast<uLong>(streambuffer.size())));
-  } while (ret == Z_OK);
-  inflateEnd(&zs);
+const PDFObject& PDFObject::Dictionary::at(PDFObject::Name key) const
+{
+  static const PDFObject nullObject;
+  const PDFObject* value{ find(key) };
+  return value != nullptr ? *value : nullObject;
+}
 
-  std::string stream(streambuffer.size(), ' ');
-  std::memcpy(stream.data(), streambuffer.data(), streambuffer.size());
-  return stream;
+std::string PDFObject::GetStream() const
+{
+  if (!HasStream())
+    return {};
+  std::string data;
+  PDFStreamDecoder{ *this }.ReadAll(data);
+  return data;
 }
 
 void PDFObject::DebugPrint(std::ostream& out) const
@@ -129,7 +125,7 @@ void PDFObject::DebugPrint(std::ostream& out, int indentation) const
     int remainingPrintCount{ static_cast<int>(GetDictionary().size()) };
     for (const auto& [key, value] : GetDictionary())
     {
-      out << indentationString << key << ": ";
+      out << indentationString << key.GetString() << ": ";
       value.DebugPrint(out, indentation + 2);
       if (--remainingPrintCount != 0)
         out << ",";
@@ -145,7 +141,7 @@ void PDFObject::DebugPrint(std::ostream& out, int indentation) const
     case Type::Boolean:    out << (GetBoolean() ? "true" : "false"); break;
     case Type::Integer:    out << GetInteger();                      break;
     case Type::Decimal:    out << GetDecimal();                      break;
-    case Type::Name:       out << "/" << GetName();                  break;
+    case Type::Name:       out << "/" << GetName().GetString();      break;
     case Type::String:     out << "\"" << GetString() << "\"";       break;
     case Type::Array:      PrintArray();                             break;
     case Type::Dictionary: PrintDictionary();                        break;
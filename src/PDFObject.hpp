@@ -1,13 +1,20 @@
 #pragma once
 
+#include "PDFName.hpp"
+#include <cstddef>
+#include <cstdint>
 #include <iosfwd>
+#include <span>
 #include <string>
-#include <unordered_map>
-#include <vector>
+#include <string_view>
 
+class PDFArena;
+
+// Small trivially copyable handle, arrays, dictionaries, decoded strings and streams are stored in the arena of the
+// document, names are interned in its name table and literal strings point into the file data
 class PDFObject
 {
-  enum class Type
+  enum class Type : uint8_t
   {
     Null,
     Boolean,
@@ -21,31 +28,34 @@ class PDFObject
   };
 
 public:
+  struct DictionaryEntry;
+  class Dictionary;
+
   using ID = int;
   using Boolean = bool;
   using Integer = int64_t;
   using Decimal = float;
-  using Name = std::string;
-  using String = std::string;
-  using Array = std::vector<PDFObject>;
-  using Dictionary = std::unordered_map<Name, PDFObject>;
+  using Name = PDFName;
+  using String = std::string_view;
+  using Array = std::span<const PDFObject>;
   using Reference = ID;
-  using Stream = std::vector<std::byte>;
+  using Stream = std::span<const std::byte>;
 
 private:
+  union
+  {
+    Integer m_integer{ 0 };
+    Boolean m_boolean;
+    Decimal m_decimal;
+    Reference m_reference;
+    const std::string_view* m_name;
+    const char* m_characters;
+    const PDFObject* m_array;
+    const DictionaryEntry* m_dictionary;
+  };
+  uint32_t m_size{ 0 }; // Number of string characters, array entries or dictionary entries
   Type m_type{ Type::Null };
-  // TODO: Change to union?
-  Boolean m_boolean;
-  Integer m_integer;
-  Decimal m_decimal;
-  Name m_name;
-  String m_string;
-  Array m_array;
-  Dictionary m_dictionary;
-  Reference m_reference;
-
-  bool m_hasStream{ false };
-  Stream m_stream;
+  const Stream* m_stream{ nullptr };
 
   void DebugPrint(std::ostream& out, int indentation) const;
 
@@ -59,30 +69,66 @@ public:
   bool IsArray() const { return m_type == Type::Array; }
   bool IsDictionary() const { return m_type == Type::Dictionary; }
   bool IsReference() const { return m_type == Type::Reference; }
-  bool HasStream() const { return m_hasStream; }
-
-  Boolean GetBoolean() const { return m_boolean; }
-  Integer GetInteger() const { return m_integer; }
-  Decimal GetDecimal() const { return m_decimal; }
-  Decimal GetDecimalOrInt() const { return m_type == Type::Integer ? static_cast<Decimal>(m_integer) : m_decimal; }
-  const Name& GetName() const { return m_name; }
-  const String& GetString() const { return m_string; }
-  const Array& GetArray() const { return m_array; }
-  const Dictionary& GetDictionary() const { return m_dictionary; }
-  const Reference& GetReference() const { return m_reference; }
+  bool HasStream() const { return m_stream != nullptr; }
+
+  Boolean GetBoolean() const { return IsBoolean() && m_boolean; }
+  Integer GetInteger() const { return IsInteger() ? m_integer : 0; }
+  Decimal GetDecimal() const { return IsDecimal() ? m_decimal : 0.0f; }
+  Decimal GetDecimalOrInt() const { return IsInteger() ? static_cast<Decimal>(m_integer) : GetDecimal(); }
+  Name GetName() const { return IsName() ? Name{ m_name } : Name{}; }
+  String GetString() const { return IsString() ? String{ m_characters, m_size } : String{}; }
+  Array GetArray() const { return IsArray() ? Array{ m_array, m_size } : Array{}; }
+  Dictionary GetDictionary() const;
+  Reference GetReference() const { return IsReference() ? m_reference : -1; }
+  Stream GetRawStream() const { return HasStream() ? *m_stream : Stream{}; }
+  // Decodes the stream with its filters
   std::string GetStream() const;
 
+  // The views passed to the setters have to outlive the object
   void SetNull();
   void SetBoolean(Boolean boolean);
   void SetInteger(Integer integer);
   void SetDecimal(Decimal decimal);
-  void SetName(const Name& name);
-  void SetString(const String& string);
-  void AddArrayEntry(const PDFObject& pdfObject);
-  void AddDictionaryEntry(const Name& name, const PDFObject& pdfObject);
-  void SetReference(const Reference& reference);
-  void SetStream(const Stream& stream);
+  void SetName(Name name);
+  void SetString(String string);
+  void SetArray(Array array);
+  void SetDictionary(const Dictionary& dictionary);
+  void SetReference(Reference reference);
+  void SetStream(Stream stream, PDFArena& arena);
 
   void DebugPrint(std::ostream& out) const;
   friend std::ostream& operator<<(std::ostream& out, const PDFObject& pdfObject);
 };
+
+struct PDFObject::DictionaryEntry
+{
+  Name m_key;
+  PDFObject m_value;
+};
+
+// View of the entries of a dictionary sorted by key, looking up a missing key returns a null object
+class PDFObject::Dictionary
+{
+  std::span<const DictionaryEntry> m_entries;
+
+public:
+  Dictionary() = default;
+  explicit Dictionary(std::span<const DictionaryEntry> entries)
+    : m_entries(entries)
+  {
+  }
+
+  auto begin() const { return m_entries.begin(); }
+  auto end() const { return m_entries.end(); }
+  size_t size() const { return m_entries.size(); }
+  bool empty() const { return m_entries.empty(); }
+
+  const PDFObject* find(Name key) const;
+  bool contains(Name key) const { return find(key) != nullptr; }
+  const PDFObject& at(Name key) const;
+};
+
+inline PDFObject::Dictionary PDFObject::GetDictionary() const
+{
+  return IsDictionary() ? Dictionary{ { m_dictionary, m_size } } : Dictionary{};
+}
@@ -0,0 +1,22 @@
+#include "PDFOperandStack.hpp"
+#include <algorithm>
+
+void PDFOperandStack::DiscardBottom()
+{
+  // Only malformed streams have this many operands, the operator uses the topmost ones so the oldest is dropped
+  std::copy(m_numbers.begin() + 1, m_numbers.end(), m_numbers.begin());
+  std::copy(m_texts.begin() + 1, m_texts.end(), m_texts.begin());
+  std::copy(m_types.begin() + 1, m_types.end(), m_types.begin());
+  m_size--;
+  m_numberCount = std::min(m_numberCount, m_size);
+}
+
+void PDFOperandStack::Push(Type type, std::string_view text)
+{
+  if (m_size == CAPACITY)
+    DiscardBottom();
+  m_texts[m_size] = text;
+  m_types[m_size] = type;
+  m_size++;
+  m_numberCount = 0;
+}
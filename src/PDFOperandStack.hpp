@@ -0,0 +1,68 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+// Operands of the next content stream operator. The capacity is fixed, operators take at most a handful of operands so
+// the stack stays in cache and never allocates. Numbers are stored contiguously, so operators read them as a span.
+class PDFOperandStack
+{
+public:
+  enum class Type : uint8_t
+  {
+    Number,
+    Name,       // Text without the slash
+    String,     // Text without the parentheses, escape sequences are not decoded
+    HexString,  // Text without the angle brackets
+    Array,      // Text between the brackets, nested arrays and dictionaries included
+    Dictionary, // Text between the double angle brackets
+    Keyword,    // true, false and null
+  };
+
+  // More operands than any operator takes, sc and scn with the 32 components of a DeviceN color space being the most
+  static constexpr size_t CAPACITY{ 48 };
+
+private:
+  std::array<float, CAPACITY> m_numbers{};
+  std::array<std::string_view, CAPACITY> m_texts;
+  std::array<Type, CAPACITY> m_types{};
+  size_t m_size{ 0 };
+  // Number of consecutive numbers at the top of the stack
+  size_t m_numberCount{ 0 };
+
+  void DiscardBottom();
+
+public:
+  void PushNumber(float number)
+  {
+    if (m_size == CAPACITY)
+      DiscardBottom();
+    m_numbers[m_size] = number;
+    m_types[m_size] = Type::Number;
+    m_size++;
+    m_numberCount++;
+  }
+  void Push(Type type, std::string_view text);
+  void Clear()
+  {
+    m_size = 0;
+    m_numberCount = 0;
+  }
+
+  size_t GetSize() const { return m_size; }
+  size_t GetNumberCount() const { return m_numberCount; }
+  // Index 0 is the topmost operand, the index has to be less than GetSize(). The text is only set for operands which
+  // are not numbers.
+  Type GetType(size_t index) const { return m_types[m_size - 1 - index]; }
+  std::string_view GetText(size_t index) const { return m_texts[m_size - 1 - index]; }
+  // The topmost count operands in the order they were pushed, empty if they are not all numbers
+  std::span<const float> GetNumbers(size_t count) const
+  {
+    if (count > m_numberCount)
+      return {};
+    return std::span{ m_numbers }.subspan(m_size - count, count);
+  }
+};
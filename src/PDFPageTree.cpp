@@ -0,0 +1,282 @@
+#include "PDFPageTree.hpp"
+#include "PDFDocument.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <utility>
+
+namespace
+{
+// Deeper trees are treated as malformed, this also stops the descent on cycles
+constexpr int MAX_DEPTH{ 256 };
+} // namespace
+
+PDFPageTree::PDFPageTree(const PDFDocument& document)
+  : m_document(document)
+{
+  const PDFObject& catalog{ m_document.Resolve(m_document.GetTrailer().GetDictionary().at(PDFName::Root)) };
+  m_rootId = catalog.GetDictionary().at(PDFName::Pages).GetReference();
+  if (m_rootId < 0)
+    std::cerr << "Document has no page tree\n";
+}
+
+bool PDFPageTree::IsNode(const PDFObject& dictionary) const
+{
+  return dictionary.GetDictionary().at(PDFName::Type).GetName() == PDFName::Pages ||
+         m_document.Resolve(dictionary.GetDictionary().at(PDFName::Kids)).IsArray();
+}
+
+const PDFObject& PDFPageTree::Resolve(const PDFObject& pdfObject, std::vector<PDFObject::ID>& objectIds) const
+{
+  if (pdfObject.IsReference())
+    objectIds.push_back(pdfObject.GetReference());
+  return m_document.Resolve(pdfObject);
+}
+
+void PDFPageTree::Inherit(const PDFObject& dictionary, Attributes& attributes) const
+{
+  // Values of the wrong type are ignored, so the value of the ancestor stays in effect
+  auto InheritAttribute{ [&](PDFName key, PDFObject& attribute, bool (PDFObject::*HasType)() const)
+  {
+    if (const PDFObject& value{ Resolve(dictionary.GetDictionary().at(key), attributes.m_objectIds) };
+        (value.*HasType)())
+      attribute = value;
+  } };
+
+  InheritAttribute(PDFName::MediaBox, attributes.m_mediaBox, &PDFObject::IsArray);
+  InheritAttribute(PDFName::CropBox, attributes.m_cropBox, &PDFObject::IsArray);
+  InheritAttribute(PDFName::Resources, attributes.m_resources, &PDFObject::IsDictionary);
+  InheritAttribute(PDFName::Rotate, attributes.m_rotate, &PDFObject::IsInteger);
+}
+
+size_t PDFPageTree::CountPages(PDFObject::ID nodeId,
+                               int depth,
+                               std::unordered_set<PDFObject::ID>& visitedIds) const
+{
+  if (!visitedIds.insert(nodeId).second)
+    return 0;
+  const PDFObject& node{ m_document.GetObject(nodeId) };
+  if (!IsNode(node))
+    return node.IsDictionary() ? 1 : 0;
+
+  const PDFObject& count{ m_document.Resolve(node.GetDictionary().at(PDFName::Count)) };
+  if (count.IsInteger() && count.GetInteger() >= 0)
+    return static_cast<size_t>(count.GetInteger());
+
+  // Broken /Count, the subtree has to be walked
+  if (depth >= MAX_DEPTH)
+    return 0;
+  size_t pageCount{ 0 };
+  for (const auto& kid : m_document.Resolve(node.GetDictionary().at(PDFName::Kids)).GetArray())
+    pageCount += CountPages(kid.GetReference(), depth + 1, visitedIds);
+  return pageCount;
+}
+
+PDFPageTree::Page PDFPageTree::CreatePage(PDFObject::ID objectId,
+                                          const PDFObject& dictionary,
+                                          const Attributes& attributes) const
+{
+  Page page;
+  page.m_objectId = objectId;
+  page.m_dictionary = dictionary;
+  page.m_resources = attributes.m_resources;
+  page.m_objectIds = attributes.m_objectIds;
+  const int rotate{ static_cast<int>(attributes.m_rotate.GetInteger() % 360) };
+  page.m_rotate = (rotate + 360) % 360 / 90 * 90;
+
+  // Letter size is the usual default of viewers for pages without a valid media box
+  if (!ReadRectangle(attributes.m_mediaBox, page.m_mediaBox, page.m_objectIds))
+    page.m_mediaBox = Rectangle{ { 0.0f, 0.0f }, { 612.0f, 792.0f } };
+  // The crop box is clipped to the media box, a crop box outside of it is ignored
+  page.m_cropBox = page.m_mediaBox;
+  if (Rectangle cropBox; ReadRectangle(attributes.m_cropBox, cropBox, page.m_objectIds))
+  {
+    const Rectangle& mediaBox{ page.m_mediaBox };
+    Rectangle clippedCropBox;
+    clippedCropBox.min = { std::max(cropBox.min.x, mediaBox.min.x), std::max(cropBox.min.y, mediaBox.min.y) };
+    clippedCropBox.max = { std::min(cropBox.max.x, mediaBox.max.x), std::min(cropBox.max.y, mediaBox.max.y) };
+    if (clippedCropBox.Width() > 0.0f && clippedCropBox.Height() > 0.0f)
+      page.m_cropBox = clippedCropBox;
+  }
+  return page;
+}
+
+bool PDFPageTree::ReadRectangle(const PDFObject& array,
+                                Rectangle& rectangle,
+                                std::vector<PDFObject::ID>& objectIds) const
+{
+  const auto entries{ array.GetArray() };
+  if (entries.size() != 4)
+    return false;
+
+  float coordinates[4];
+  for (size_t i{ 0 }; i < 4; ++i)
+  {
+    const PDFObject& entry{ Resolve(entries[i], objectIds) };
+    if (!entry.IsInteger() && !entry.IsDecimal())
+      return false;
+    coordinates[i] = entry.GetDecimalOrInt();
+  }
+
+  // Any two opposite corners are allowed
+  rectangle.min = { std::min(coordinates[0], coordinates[2]), std::min(coordinates[1], coordinates[3]) };
+  rectangle.max = { std::max(coordinates[0], coordinates[2]), std::max(coordinates[1], coordinates[3]) };
+  return true;
+}
+
+size_t PDFPageTree::GetPageCount() const
+{
+  std::unordered_set<PDFObject::ID> visitedIds;
+  return m_rootId >= 0 ? CountPages(m_rootId, 0, visitedIds) : 0;
+}
+
+bool PDFPageTree::FindPage(size_t pageIndex, Page& page, NodeStack* followingNodes) const
+{
+  if (m_rootId < 0)
+    return false;
+
+  const size_t requestedPageIndex{ pageIndex };
+  Attributes attributes;
+  PDFObject::ID nodeId{ m_rootId };
+  // Pushes the kids after the one which is descended into, the walk continues with them after the page
+  auto PushFollowingKids{ [&](PDFObject::Array kids, size_t kidIndex)
+  {
+    if (!followingNodes)
+      return;
+    for (size_t i{ kids.size() }; i > kidIndex + 1; --i)
+    {
+      if (kids[i - 1].IsReference())
+        followingNodes->emplace_back(kids[i - 1].GetReference(), attributes);
+    }
+  } };
+
+  for (int depth{ 0 }; depth < MAX_DEPTH; ++depth)
+  {
+    const PDFObject& node{ m_document.GetObject(nodeId) };
+    if (!node.IsDictionary())
+      break;
+    attributes.m_objectIds.push_back(nodeId);
+    Inherit(node, attributes);
+
+    if (!IsNode(node))
+    {
+      if (pageIndex != 0)
+        break;
+      page = CreatePage(nodeId, node, attributes);
+      return true;
+    }
+
+    const auto kids{ Resolve(node.GetDictionary().at(PDFName::Kids), attributes.m_objectIds).GetArray() };
+
+    // In a node with as many pages as kids the kids are usually all pages. The kid at the index of the page is only the
+    // page if all kids before it are pages too, an empty node before it and a node with two pages after it give the
+    // same count. Checking them needs neither their /Count nor a visited set for each of them.
+    auto IsPage{ [&](const PDFObject& kid)
+    {
+      const PDFObject& kidObject{ m_document.GetObject(kid.GetReference()) };
+      return kidObject.IsDictionary() && !IsNode(kidObject);
+    } };
+    const PDFObject& count{ Resolve(node.GetDictionary().at(PDFName::Count), attributes.m_objectIds) };
+    if (count.GetInteger() == static_cast<PDFObject::Integer>(kids.size()) && pageIndex < kids.size() &&
+        std::all_of(kids.begin(), kids.begin() + static_cast<ptrdiff_t>(pageIndex), IsPage))
+    {
+      const PDFObject::ID kidId{ kids[pageIndex].GetReference() };
+      if (const PDFObject& kid{ m_document.GetObject(kidId) }; kid.IsDictionary() && !IsNode(kid))
+      {
+        PushFollowingKids(kids, pageIndex);
+        attributes.m_objectIds.push_back(kidId);
+        Inherit(kid, attributes);
+        page = CreatePage(kidId, kid, attributes);
+        return true;
+      }
+    }
+
+    // Skips the kids before the page as a whole, only their /Count is read
+    PDFObject::ID nextNodeId{ -1 };
+    for (size_t kidIndex{ 0 }; kidIndex < kids.size(); ++kidIndex)
+    {
+      std::unordered_set<PDFObject::ID> visitedIds;
+      const size_t kidPageCount{ CountPages(kids[kidIndex].GetReference(), depth + 1, visitedIds) };
+      if (pageIndex < kidPageCount)
+      {
+        nextNodeId = kids[kidIndex].GetReference();
+        PushFollowingKids(kids, kidIndex);
+        break;
+      }
+      pageIndex -= kidPageCount;
+    }
+    if (nextNodeId < 0)
+      break;
+    nodeId = nextNodeId;
+  }
+
+  std::cerr << "Failed to find page " << requestedPageIndex << " in the page tree\n";
+  return false;
+}
+
+void PDFPageTree::WalkPages(NodeStack& nodes,
+                            size_t pageCount,
+                            std::unordered_set<PDFObject::ID>& visitedIds,
+                            std::vector<Page>& pages) const
+{
+  // Depth-first in document order, the kids are pushed in reverse so the first one is visited next
+  while (!nodes.empty() && pages.size() < pageCount)
+  {
+    auto [nodeId, attributes]{ std::move(nodes.back()) };
+    nodes.pop_back();
+    if (!visitedIds.insert(nodeId).second)
+    {
+      std::cerr << "Page tree contains object " << nodeId << " more than once\n";
+      continue;
+    }
+
+    const PDFObject& node{ m_document.GetObject(nodeId) };
+    if (!node.IsDictionary())
+      continue;
+    attributes.m_objectIds.push_back(nodeId);
+    Inherit(node, attributes);
+
+    if (!IsNode(node))
+    {
+      pages.push_back(CreatePage(nodeId, node, attributes));
+      continue;
+    }
+
+    const auto kids{ Resolve(node.GetDictionary().at(PDFName::Kids), attributes.m_objectIds).GetArray() };
+    for (auto it{ kids.rbegin() }; it != kids.rend(); ++it)
+    {
+      if (it->IsReference())
+        nodes.emplace_back(it->GetReference(), attributes);
+    }
+  }
+}
+
+bool PDFPageTree::GetPage(size_t pageIndex, Page& page) const
+{
+  return FindPage(pageIndex, page, nullptr);
+}
+
+std::vector<PDFPageTree::Page> PDFPageTree::GetPages() const
+{
+  std::vector<Page> pages;
+  if (m_rootId < 0)
+    return pages;
+
+  NodeStack nodes{ { m_rootId, Attributes{} } };
+  std::unordered_set<PDFObject::ID> visitedIds;
+  WalkPages(nodes, SIZE_MAX, visitedIds, pages);
+  return pages;
+}
+
+std::vector<PDFPageTree::Page> PDFPageTree::GetPages(size_t firstPageIndex, size_t pageCount) const
+{
+  std::vector<Page> pages;
+  NodeStack followingNodes;
+  if (pageCount == 0 || !FindPage(firstPageIndex, pages.emplace_back(), &followingNodes))
+    return {};
+
+  // The first page and its ancestors were visited by the descent
+  std::unordered_set<PDFObject::ID> visitedIds{ pages.front().m_objectIds.begin(), pages.front().m_objectIds.end() };
+  WalkPages(followingNodes, pageCount, visitedIds, pages);
+  return pages;
+}
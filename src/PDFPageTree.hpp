@@ -0,0 +1,73 @@
+#pragma once
+
+#include "PDFObject.hpp"
+#include "math/Rectangle.hpp"
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+class PDFDocument;
+
+// Walks the page tree from /Root /Pages. Only the nodes which are needed are resolved, so pages can be looked up on a
+// lazily loaded document without parsing the rest of the file.
+class PDFPageTree
+{
+public:
+  struct Page
+  {
+    PDFObject::ID m_objectId{ -1 };
+    PDFObject m_dictionary;
+    // Inheritable attributes, taken from the nearest ancestor if the page does not have them
+    Rectangle m_mediaBox;
+    Rectangle m_cropBox; // Visible part of the page, always inside of the media box
+    PDFObject m_resources;
+    int m_rotate{ 0 }; // Degrees clockwise, a multiple of 90. The renderer does not rotate pages yet.
+    // The page, its ancestors and the other objects which were resolved for its attributes
+    std::vector<PDFObject::ID> m_objectIds;
+  };
+
+private:
+  const PDFDocument& m_document;
+  PDFObject::ID m_rootId{ -1 };
+
+  struct Attributes
+  {
+    PDFObject m_mediaBox;
+    PDFObject m_cropBox;
+    PDFObject m_resources;
+    PDFObject m_rotate;
+    std::vector<PDFObject::ID> m_objectIds;
+  };
+  // Nodes which are still to be walked with the attributes of their parent, the next one is at the back
+  using NodeStack = std::vector<std::pair<PDFObject::ID, Attributes>>;
+
+  bool IsNode(const PDFObject& dictionary) const;
+  // Records the ID of the object if it is a reference
+  const PDFObject& Resolve(const PDFObject& pdfObject, std::vector<PDFObject::ID>& objectIds) const;
+  void Inherit(const PDFObject& dictionary, Attributes& attributes) const;
+  // Nodes in visitedIds are counted as empty, so shared or cyclic kids are only walked once if /Count is broken
+  size_t CountPages(PDFObject::ID nodeId, int depth, std::unordered_set<PDFObject::ID>& visitedIds) const;
+  Page CreatePage(PDFObject::ID objectId, const PDFObject& dictionary, const Attributes& attributes) const;
+  bool ReadRectangle(const PDFObject& array, Rectangle& rectangle, std::vector<PDFObject::ID>& objectIds) const;
+  // Descends only into the subtree which contains the page, using /Count to skip the others. The kids after the ones
+  // it descends into are pushed onto followingNodes if it is set.
+  bool FindPage(size_t pageIndex, Page& page, NodeStack* followingNodes) const;
+  // Appends the pages of the nodes depth-first in document order until pages has pageCount entries. Nodes which are in
+  // visitedIds already are skipped.
+  void WalkPages(NodeStack& nodes,
+                 size_t pageCount,
+                 std::unordered_set<PDFObject::ID>& visitedIds,
+                 std::vector<Page>& pages) const;
+
+public:
+  explicit PDFPageTree(const PDFDocument& document);
+
+  size_t GetPageCount() const;
+  // Descends only into the subtree which contains the page, using /Count to skip the others
+  bool GetPage(size_t pageIndex, Page& page) const;
+  // All pages in document order
+  std::vector<Page> GetPages() const;
+  // The pages [firstPageIndex, firstPageIndex + pageCount) in document order. The tree is descended to the first page
+  // like GetPage does, only the pages after it are walked.
+  std::vector<Page> GetPages(size_t firstPageIndex, size_t pageCount) const;
+};
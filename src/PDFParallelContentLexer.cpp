@@ -0,0 +1,135 @@
+#include "PDFParallelContentLexer.hpp"
+#include "PDFParser.hpp"
+#include <algorithm>
+#include <execution>
+#include <thread>
+
+namespace
+{
+// Streams smaller than this are tokenized faster than the batches can be distributed
+constexpr size_t MIN_PARALLEL_SIZE{ 4 * 1024 * 1024 };
+
+// The text of names and strings starts after their delimiter
+size_t GetTokenStart(std::string_view data, const PDFContentLexer::Token& token)
+{
+  const size_t textStart{ static_cast<size_t>(token.m_text.data() - data.data()) };
+  switch (token.m_type)
+  {
+    case PDFContentLexer::Token::Type::Name:
+    case PDFContentLexer::Token::Type::String:
+    case PDFContentLexer::Token::Type::HexString:
+      return textStart - 1;
+    default:
+      return textStart;
+  }
+}
+} // namespace
+
+bool PDFParallelContentLexer::IsWorthwhile(size_t dataSize)
+{
+  return dataSize >= MIN_PARALLEL_SIZE && std::thread::hardware_concurrency() > 1;
+}
+
+PDFParallelContentLexer::PDFParallelContentLexer(std::string_view data, size_t chunkSize, size_t chunksPerBatch)
+  : m_data(data)
+  , m_chunkSize(std::max<size_t>(chunkSize, 1))
+  , m_chunksPerBatch(chunksPerBatch > 0 ? chunksPerBatch : std::max(2u, 2 * std::thread::hardware_concurrency()))
+{
+  // A chunk ends at the first whitespace after its nominal size, which in most cases is between two tokens
+  for (size_t chunkEnd{ 0 }; chunkEnd < m_data.size();)
+  {
+    chunkEnd = std::min(chunkEnd + m_chunkSize, m_data.size());
+    while (chunkEnd < m_data.size() && !PDFParser::IsWhitespace(m_data[chunkEnd]))
+      chunkEnd++;
+    m_chunkEnds.push_back(chunkEnd);
+  }
+
+  StartNextBatch();
+}
+
+void PDFParallelContentLexer::TokenizeChunk(std::string_view data, size_t begin, size_t limit, Chunk& chunk)
+{
+  // Tokens which start in the chunk may end after it, so the lexer gets the data up to the limit
+  PDFContentLexer lexer{ data.substr(begin, limit - begin) };
+  chunk.m_tokens.clear();
+  chunk.m_firstTokenStart = limit;
+  chunk.m_nextTokenStart = limit;
+  chunk.m_complete = limit == data.size();
+  for (bool firstToken{ true };; firstToken = false)
+  {
+    const PDFContentLexer::Token token{ lexer.Next() };
+    if (token.m_type == PDFContentLexer::Token::Type::End)
+      return;
+
+    const size_t tokenStart{ GetTokenStart(data, token) };
+    if (firstToken)
+      chunk.m_firstTokenStart = tokenStart;
+    if (tokenStart >= chunk.m_end)
+    {
+      // Only the start of this token is needed, so it does not matter whether the limit cut it off
+      chunk.m_nextTokenStart = tokenStart;
+      chunk.m_complete = true;
+      return;
+    }
+    chunk.m_tokens.push_back(token);
+  }
+}
+
+std::vector<PDFParallelContentLexer::Chunk> PDFParallelContentLexer::TokenizeBatch(size_t firstChunk) const
+{
+  std::vector<Chunk> chunks(std::min(m_chunksPerBatch, m_chunkEnds.size() - firstChunk));
+  for (size_t chunkIndex{ 0 }; chunkIndex < chunks.size(); ++chunkIndex)
+  {
+    chunks[chunkIndex].m_begin = firstChunk + chunkIndex > 0 ? m_chunkEnds[firstChunk + chunkIndex - 1] : 0;
+    chunks[chunkIndex].m_end = m_chunkEnds[firstChunk + chunkIndex];
+  }
+
+  std::for_each(std::execution::par,
+                chunks.begin(),
+                chunks.end(),
+                [&](Chunk& chunk)
+  { TokenizeChunk(m_data, chunk.m_begin, std::min(chunk.m_end + m_chunkSize, m_data.size()), chunk); });
+  return chunks;
+}
+
+void PDFParallelContentLexer::StartNextBatch()
+{
+  if (m_nextBatchFirstChunk >= m_chunkEnds.size())
+    return;
+
+  const size_t firstChunk{ m_nextBatchFirstChunk };
+  m_nextBatchFirstChunk += m_chunksPerBatch;
+  m_nextBatch = std::async(std::launch::async, [this, firstChunk]() { return TokenizeBatch(firstChunk); });
+}
+
+bool PDFParallelContentLexer::NextChunk()
+{
+  while (true)
+  {
+    if (m_chunkIndex == m_batch.size())
+    {
+      if (!m_nextBatch.valid())
+        return false;
+      m_batch = m_nextBatch.get();
+      m_chunkIndex = 0;
+      StartNextBatch();
+
+      // A chunk whose first token is not the one after the previous chunk started inside a string, a comment or
+      // inline image data. Tokenizing it again from there is serial, but the stream is only wrong at a few places.
+      for (Chunk& chunk : m_batch)
+      {
+        if (!chunk.m_complete || (chunk.m_begin > 0 && chunk.m_firstTokenStart != m_nextTokenStart))
+          TokenizeChunk(m_data, chunk.m_begin > 0 ? m_nextTokenStart : 0, m_data.size(), chunk);
+        m_nextTokenStart = chunk.m_nextTokenStart;
+      }
+    }
+
+    const std::vector<PDFContentLexer::Token>& tokens{ m_batch[m_chunkIndex++].m_tokens };
+    if (!tokens.empty())
+    {
+      m_token = tokens.data();
+      m_tokensEnd = tokens.data() + tokens.size();
+      return true;
+    }
+  }
+}
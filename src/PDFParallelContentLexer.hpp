@@ -0,0 +1,62 @@
+#pragma once
+
+#include "PDFContentLexer.hpp"
+#include <cstddef>
+#include <future>
+#include <string_view>
+#include <vector>
+
+// Tokenizes a large content stream on several threads. The stream is split into chunks at whitespace, a batch of chunks
+// is tokenized in parallel while the tokens of the previous batch are read. Tokenizing is context-free except inside
+// strings, comments and inline image data, a chunk which started inside one of them is tokenized again from the first
+// token after the previous chunk before its tokens are read. The tasks only look one chunk beyond the end of their
+// chunk, chunks with longer tokens are tokenized again as a whole.
+class PDFParallelContentLexer
+{
+  static constexpr size_t CHUNK_SIZE{ 256 * 1024 };
+
+  struct Chunk
+  {
+    size_t m_begin{ 0 };
+    size_t m_end{ 0 };
+    std::vector<PDFContentLexer::Token> m_tokens; // The tokens which start in [m_begin, m_end)
+    size_t m_firstTokenStart{ 0 };                // Start of the first token found from m_begin
+    size_t m_nextTokenStart{ 0 };                 // Start of the first token at or after m_end
+    bool m_complete{ false };                     // False if a token was longer than the data it was tokenized with
+  };
+
+  std::string_view m_data;
+  size_t m_chunkSize{ CHUNK_SIZE };
+  std::vector<size_t> m_chunkEnds;
+  size_t m_chunksPerBatch{ 1 };
+
+  std::vector<Chunk> m_batch;
+  std::future<std::vector<Chunk>> m_nextBatch;
+  size_t m_nextBatchFirstChunk{ 0 };
+  size_t m_chunkIndex{ 0 }; // In m_batch
+  const PDFContentLexer::Token* m_token{ nullptr };
+  const PDFContentLexer::Token* m_tokensEnd{ nullptr };
+  size_t m_nextTokenStart{ 0 }; // Of the last chunk which was checked
+
+  static void TokenizeChunk(std::string_view data, size_t begin, size_t limit, Chunk& chunk);
+  std::vector<Chunk> TokenizeBatch(size_t firstChunk) const;
+  void StartNextBatch();
+  bool NextChunk();
+
+public:
+  // Parallel tokenizing only pays off for large streams on machines with several cores
+  static bool IsWorthwhile(size_t dataSize);
+
+  // By default a batch has two chunks for each hardware thread
+  explicit PDFParallelContentLexer(std::string_view data, size_t chunkSize = CHUNK_SIZE, size_t chunksPerBatch = 0);
+  PDFParallelContentLexer(const PDFParallelContentLexer&) = delete;
+  PDFParallelContentLexer& operator=(const PDFParallelContentLexer&) = delete;
+
+  // Returns the same tokens as PDFContentLexer::Next
+  PDFContentLexer::Token Next()
+  {
+    if (m_token == m_tokensEnd && !NextChunk())
+      return {};
+    return *m_token++;
+  }
+};
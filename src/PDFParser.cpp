@@ -0,0 +1,296 @@
+#include "PDFParser.hpp"
+#include "PDFArena.hpp"
+#include "PDFName.hpp"
+#include <algorithm>
+#include <charconv>
+#include <iostream>
+
+namespace
+{
+void NotImplemented(const std::string& function)
+{
+  std::cerr << function << " not implemented\n";
+}
+
+char ConvertNibble(char n)
+{
+  if (n >= 'a' && n <= 'f')
+    return static_cast<char>(n - 'a' + 10);
+  else if (n >= 'A' && n <= 'F')
+    return static_cast<char>(n - 'A' + 10);
+  return static_cast<char>(n - '0');
+}
+} // namespace
+
+PDFParser::PDFParser(std::string_view data, size_t position)
+  : m_data(data)
+  , m_position(position)
+{
+}
+
+bool PDFParser::ParseInteger(std::string_view token, PDFObject::Integer& integer)
+{
+  if (!token.empty() && token.front() == '+')
+    token.remove_prefix(1);
+  auto [end, error]{ std::from_chars(token.data(), token.data() + token.size(), integer) };
+  return error == std::errc{} && end == token.data() + token.size();
+}
+
+bool PDFParser::ParseDecimal(std::string_view token, PDFObject::Decimal& decimal)
+{
+  // Checking the first character also keeps from_chars from accepting "inf" and "nan"
+  if (token.empty() || !(IsDigit(token.front()) || token.front() == '.' || token.front() == '-' || token.front() == '+'))
+    return false;
+  if (token.front() == '+')
+    token.remove_prefix(1);
+  auto [end, error]{ std::from_chars(token.data(), token.data() + token.size(), decimal) };
+  return error == std::errc{};
+}
+
+bool PDFParser::AtEnd() const
+{
+  return m_position >= m_data.size();
+}
+
+size_t PDFParser::GetPosition() const
+{
+  return m_position;
+}
+
+void PDFParser::SetPosition(size_t position)
+{
+  m_position = std::min(position, m_data.size());
+}
+
+char PDFParser::PeekChar() const
+{
+  return AtEnd() ? '\0' : m_data[m_position];
+}
+
+char PDFParser::GetChar()
+{
+  return AtEnd() ? '\0' : m_data[m_position++];
+}
+
+void PDFParser::SkipWhitespace()
+{
+  while (!AtEnd())
+  {
+    if (IsWhitespace(m_data[m_position]))
+      m_position++;
+    else if (m_data[m_position] == '%')
+    {
+      while (!AtEnd() && m_data[m_position] != '\r' && m_data[m_position] != '\n')
+        m_position++;
+    }
+    else
+      break;
+  }
+}
+
+std::string_view PDFParser::ReadToken()
+{
+  size_t start{ m_position };
+  while (!AtEnd() && !IsWhitespace(m_data[m_position]) && !IsDelimiter(m_data[m_position]))
+    m_position++;
+  return m_data.substr(start, m_position - start);
+}
+
+bool PDFParser::ReadInteger(PDFObject::Integer& integer)
+{
+  SkipWhitespace();
+  return ParseInteger(ReadToken(), integer);
+}
+
+bool PDFParser::ReadObjectHeader(PDFObject::ID& objectId)
+{
+  PDFObject::Integer id, generationNumber;
+  if (!ReadInteger(id) || !ReadInteger(generationNumber))
+    return false;
+  SkipWhitespace();
+  if (ReadToken() != "obj")
+    return false;
+  objectId = static_cast<PDFObject::ID>(id);
+  return true;
+}
+
+void PDFParser::SkipEndOfLine()
+{
+  // The "stream" keyword is followed by CRLF or LF, a lone CR is tolerated for broken generators
+  if (PeekChar() == '\r')
+    GetChar();
+  if (PeekChar() == '\n')
+    GetChar();
+}
+
+PDFObject PDFParser::ReadObject(PDFArena& arena, PDFNameTable& names)
+{
+  SkipWhitespace();
+
+  char c{ PeekChar() };
+  if (IsDigit(c) || c == '.' || c == '-' || c == '+')
+  {
+    std::string_view token{ ReadToken() };
+    if (token.find_first_of('.') != std::string_view::npos)
+    {
+      PDFObject::Decimal decimal{ 0.0f };
+      ParseDecimal(token, decimal);
+      PDFObject pdfObject;
+      pdfObject.SetDecimal(decimal);
+      return pdfObject;
+    }
+
+    PDFObject::Integer number{ 0 };
+    ParseInteger(token, number);
+
+    // "<number> <generation> R" is a reference, otherwise rewind to just after the number
+    size_t positionAfterNumber{ m_position };
+    SkipWhitespace();
+    if (IsDigit(PeekChar()))
+    {
+      PDFObject::Integer generationNumber;
+      if (ParseInteger(ReadToken(), generationNumber))
+      {
+        SkipWhitespace();
+        if (ReadToken() == "R")
+        {
+          PDFObject pdfObject;
+          pdfObject.SetReference(static_cast<PDFObject::Reference>(number));
+          return pdfObject;
+        }
+      }
+    }
+    m_position = positionAfterNumber;
+
+    PDFObject pdfObject;
+    pdfObject.SetInteger(number);
+    return pdfObject;
+  }
+  else if (c == '/')
+  {
+    GetChar();
+    PDFObject pdfObject;
+    pdfObject.SetName(names.Intern(ReadToken()));
+    return pdfObject;
+  }
+  else if (c == '(')
+  {
+    GetChar();
+    size_t start{ m_position };
+    size_t end{ m_data.size() };
+    int openParanthesisCount{ 1 };
+    while (!AtEnd())
+    {
+      c = GetChar();
+      if (c == '\\')
+        GetChar();
+      else if (c == '(')
+        openParanthesisCount++;
+      else if (c == ')' && --openParanthesisCount == 0)
+      {
+        end = m_position - 1;
+        break;
+      }
+    }
+
+    PDFObject pdfObject;
+    pdfObject.SetString(m_data.substr(start, end - start));
+    return pdfObject;
+  }
+  else if (c == '<')
+  {
+    GetChar();
+    if (PeekChar() == '<')
+    {
+      GetChar();
+      size_t stackStart{ m_dictionaryStack.size() };
+      SkipWhitespace();
+      while (!AtEnd() && PeekChar() != '>')
+      {
+        if (GetChar() != '/')
+          continue;
+        PDFObject::Name dictionaryKey{ names.Intern(ReadToken()) };
+        PDFObject dictionaryValue{ ReadObject(arena, names) };
+        // Later duplicates of a key replace the earlier value
+        auto entries{ std::span{ m_dictionaryStack }.subspan(stackStart) };
+        auto entry{ std::ranges::find(entries, dictionaryKey, &PDFObject::DictionaryEntry::m_key) };
+        if (entry != entries.end())
+          entry->m_value = dictionaryValue;
+        else
+          m_dictionaryStack.push_back({ dictionaryKey, dictionaryValue });
+        SkipWhitespace();
+      }
+      GetChar();
+      GetChar();
+
+      auto entries{ std::span{ m_dictionaryStack }.subspan(stackStart) };
+      std::ranges::sort(entries, {}, &PDFObject::DictionaryEntry::m_key);
+      PDFObject pdfObject;
+      pdfObject.SetDictionary(PDFObject::Dictionary{ arena.Copy(entries) });
+      m_dictionaryStack.resize(stackStart);
+      return pdfObject;
+    }
+    else
+    {
+      std::string string;
+      char upperNibble{ 0 };
+      bool hasUpperNibble{ false };
+      while (!AtEnd())
+      {
+        c = GetChar();
+        if (c == '>')
+          break;
+        if (IsWhitespace(c))
+          continue;
+        if (hasUpperNibble)
+          string += static_cast<char>((upperNibble << 4) | ConvertNibble(c));
+        else
+          upperNibble = ConvertNibble(c);
+        hasUpperNibble = !hasUpperNibble;
+      }
+      if (hasUpperNibble)
+        string += static_cast<char>(upperNibble << 4);
+
+      PDFObject pdfObject;
+      pdfObject.SetString({ arena.Copy(std::span{ string }).data(), string.size() });
+      return pdfObject;
+    }
+  }
+  else if (c == '[')
+  {
+    GetChar();
+    size_t stackStart{ m_arrayStack.size() };
+    SkipWhitespace();
+    while (!AtEnd() && PeekChar() != ']')
+    {
+      PDFObject arrayEntry{ ReadObject(arena, names) };
+      m_arrayStack.push_back(arrayEntry);
+      SkipWhitespace();
+    }
+    GetChar();
+
+    PDFObject pdfObject;
+    pdfObject.SetArray(arena.Copy(std::span{ m_arrayStack }.subspan(stackStart)));
+    m_arrayStack.resize(stackStart);
+    return pdfObject;
+  }
+
+  std::string_view keyword{ ReadToken() };
+  if (keyword == "null")
+  {
+    PDFObject pdfObject;
+    pdfObject.SetNull();
+    return pdfObject;
+  }
+  else if (keyword == "true" || keyword == "false")
+  {
+    PDFObject pdfObject;
+    pdfObject.SetBoolean(keyword == "true");
+    return pdfObject;
+  }
+
+  if (keyword.empty()) // Always make progress on unexpected delimiters
+    GetChar();
+  NotImplemented("\"" + (keyword.empty() ? std::string(1, c) : std::string{ keyword }) + "\"");
+  return PDFObject{};
+}
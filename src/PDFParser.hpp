@@ -0,0 +1,50 @@
+#pragma once
+
+#include "PDFObject.hpp"
+#include <string_view>
+#include <vector>
+
+class PDFArena;
+class PDFNameTable;
+
+// Lexes PDF objects directly from a view into the file data. Literal strings of the returned objects point into this
+// view, their arrays and dictionaries into the arena and their names into the name table, so all of them must outlive
+// the objects.
+class PDFParser
+{
+  std::string_view m_data;
+  size_t m_position{ 0 };
+  // Entries of the arrays and dictionaries which are still open, they are copied to the arena once they are complete
+  std::vector<PDFObject> m_arrayStack;
+  std::vector<PDFObject::DictionaryEntry> m_dictionaryStack;
+
+public:
+  explicit PDFParser(std::string_view data, size_t position = 0);
+
+  static constexpr bool IsWhitespace(char c)
+  {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\f' || c == '\0';
+  }
+  static constexpr bool IsDelimiter(char c)
+  {
+    return c == '/' || c == '<' || c == '>' || c == '[' || c == ']' || c == '(' || c == ')' || c == '{' || c == '}' ||
+           c == '%';
+  }
+  static constexpr bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+  static bool ParseInteger(std::string_view token, PDFObject::Integer& integer);
+  // Parses the longest numeric prefix of the token like the PDF readers of other viewers do, "1.5.2" becomes 1.5
+  static bool ParseDecimal(std::string_view token, PDFObject::Decimal& decimal);
+
+  bool AtEnd() const;
+  size_t GetPosition() const;
+  void SetPosition(size_t position);
+  char PeekChar() const;
+  char GetChar();
+
+  void SkipWhitespace();
+  std::string_view ReadToken();
+  bool ReadInteger(PDFObject::Integer& integer);
+  bool ReadObjectHeader(PDFObject::ID& objectId);
+  PDFObject ReadObject(PDFArena& arena, PDFNameTable& names);
+  void SkipEndOfLine();
+};
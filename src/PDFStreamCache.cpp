@@ -0,0 +1,90 @@
+#include "PDFStreamCache.hpp"
+
+PDFStreamCache::PDFStreamCache(size_t budget)
+  : m_budget(budget)
+{
+}
+
+std::shared_ptr<const std::string> PDFStreamCache::Find(PDFObject::ID objectId)
+{
+  std::lock_guard lock{ m_mutex };
+  auto it{ m_index.find(objectId) };
+  if (it == m_index.end())
+  {
+    m_statistics.m_misses++;
+    return nullptr;
+  }
+
+  m_statistics.m_hits++;
+  m_entries.splice(m_entries.begin(), m_entries, it->second);
+  return it->second->second;
+}
+
+void PDFStreamCache::Insert(PDFObject::ID objectId, std::shared_ptr<const std::string> stream)
+{
+  std::lock_guard lock{ m_mutex };
+  if (stream->size() > m_budget)
+    return;
+
+  // Another thread can have decoded the same stream concurrently, the newer copy replaces it
+  if (auto it{ m_index.find(objectId) }; it != m_index.end())
+  {
+    m_statistics.m_size -= it->second->second->size();
+    m_entries.erase(it->second);
+  }
+
+  m_statistics.m_size += stream->size();
+  m_entries.emplace_front(objectId, std::move(stream));
+  m_index[objectId] = m_entries.begin();
+  EvictToBudget();
+}
+
+void PDFStreamCache::Erase(PDFObject::ID objectId)
+{
+  std::lock_guard lock{ m_mutex };
+  if (auto it{ m_index.find(objectId) }; it != m_index.end())
+  {
+    m_statistics.m_size -= it->second->second->size();
+    m_entries.erase(it->second);
+    m_index.erase(it);
+  }
+}
+
+void PDFStreamCache::Clear()
+{
+  std::lock_guard lock{ m_mutex };
+  m_entries.clear();
+  m_index.clear();
+  m_statistics.m_size = 0;
+}
+
+void PDFStreamCache::SetBudget(size_t budget)
+{
+  std::lock_guard lock{ m_mutex };
+  m_budget = budget;
+  EvictToBudget();
+}
+
+size_t PDFStreamCache::GetBudget() const
+{
+  std::lock_guard lock{ m_mutex };
+  return m_budget;
+}
+
+PDFStreamCache::Statistics PDFStreamCache::GetStatistics() const
+{
+  std::lock_guard lock{ m_mutex };
+  return m_statistics;
+}
+
+void PDFStreamCache::EvictToBudget()
+{
+  while (m_statistics.m_size > m_budget)
+  {
+    const Entry& entry{ m_entries.back() };
+    m_statistics.m_size -= entry.second->size();
+    m_statistics.m_evictions++;
+    m_index.erase(entry.first);
+    m_entries.pop_back();
+  }
+}
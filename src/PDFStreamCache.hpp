@@ -0,0 +1,47 @@
+#pragma once
+
+#include "PDFObject.hpp"
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Keeps the most recently used decoded streams within a byte budget. Streams are shared, so evicting one does not
+// invalidate it for readers which still hold it.
+class PDFStreamCache
+{
+public:
+  struct Statistics
+  {
+    size_t m_hits{ 0 };
+    size_t m_misses{ 0 };
+    size_t m_evictions{ 0 };
+    size_t m_size{ 0 }; // Bytes of all cached streams
+  };
+
+private:
+  using Entry = std::pair<PDFObject::ID, std::shared_ptr<const std::string>>;
+
+  mutable std::mutex m_mutex;
+  std::list<Entry> m_entries; // Most recently used first
+  std::unordered_map<PDFObject::ID, std::list<Entry>::iterator> m_index;
+  size_t m_budget;
+  Statistics m_statistics;
+
+  void EvictToBudget();
+
+public:
+  explicit PDFStreamCache(size_t budget = 64 << 20);
+
+  // Returns nullptr if the stream is not cached
+  std::shared_ptr<const std::string> Find(PDFObject::ID objectId);
+  // Streams larger than the whole budget are not cached
+  void Insert(PDFObject::ID objectId, std::shared_ptr<const std::string> stream);
+  void Erase(PDFObject::ID objectId);
+  void Clear();
+
+  void SetBudget(size_t budget);
+  size_t GetBudget() const;
+  Statistics GetStatistics() const;
+};
@@ -1,49 +1,183 @@
 #include "PDFStreamFinder.hpp"
 #include "PDFDocument.hpp"
+#include "PDFPageTree.hpp"
 #include "math/Rectangle.hpp"
+#include <algorithm>
+#include <execution>
+#include <ranges>
+#include <span>
+#include <unordered_set>
 
-std::vector<PDFStreamFinder::GraphicsStream> PDFStreamFinder::GetGraphicsStreams(
-  const std::filesystem::path& sourceFile) const
+namespace
+{
+// Nested deeper than this, forms are treated as malformed
+constexpr size_t MAX_FORM_DEPTH{ 32 };
+
+// Every object which is dereferenced for a page is recorded in objectIds, an update of any of them changes the page
+const PDFObject& GetObject(const PDFDocument& document, PDFObject::ID objectId, std::vector<PDFObject::ID>& objectIds)
+{
+  objectIds.push_back(objectId);
+  const PDFObject& pdfObject{ document.GetObject(objectId) };
+  // The length of a stream is resolved when the object is parsed
+  if (const PDFObject& length{ pdfObject.GetDictionary().at(PDFName::Length) }; length.IsReference())
+    objectIds.push_back(length.GetReference());
+  return pdfObject;
+}
+
+const PDFObject& Resolve(const PDFDocument& document,
+                         const PDFObject& pdfObject,
+                         std::vector<PDFObject::ID>& objectIds)
+{
+  return pdfObject.IsReference() ? GetObject(document, pdfObject.GetReference(), objectIds) : pdfObject;
+}
+
+bool ReadNumbers(const PDFDocument& document,
+                 const PDFObject& array,
+                 std::span<float> numbers,
+                 std::vector<PDFObject::ID>& objectIds)
+{
+  const auto entries{ Resolve(document, array, objectIds).GetArray() };
+  if (entries.size() != numbers.size())
+    return false;
+
+  for (size_t i{ 0 }; i < numbers.size(); ++i)
+  {
+    const PDFObject& entry{ Resolve(document, entries[i], objectIds) };
+    if (!entry.IsInteger() && !entry.IsDecimal())
+      return false;
+    numbers[i] = entry.GetDecimalOrInt();
+  }
+  return true;
+}
+} // namespace
+
+PDFStreamFinder::Forms PDFStreamFinder::CreateForms(const PDFDocument& document,
+                                                    const PDFObject& resources,
+                                                    FormContext& context,
+                                                    GraphicsStream& stream)
+{
+  Forms forms;
+  const PDFObject& xObjects{ Resolve(document, resources.GetDictionary().at(PDFName::XObject), stream.m_objectIds) };
+  for (const auto& [name, xObject] : xObjects.GetDictionary())
+  {
+    if (auto form{ CreateForm(document, xObject.GetReference(), context, stream) })
+      forms.emplace(name.GetString(), std::move(form));
+  }
+  return forms;
+}
+
+std::shared_ptr<const PDFStreamFinder::Form> PDFStreamFinder::CreateForm(const PDFDocument& document,
+                                                                         PDFObject::ID formId,
+                                                                         FormContext& context,
+                                                                         GraphicsStream& stream)
 {
-  PDFDocument document;
-  document.Load(sourceFile);
+  if (auto it{ context.m_createdForms.find(formId) }; it != context.m_createdForms.end())
+    return it->second;
+
+  // Images and other XObjects are not forms, a form which contains itself would be painted forever
+  const PDFObject& formObject{ GetObject(document, formId, stream.m_objectIds) };
+  const auto dictionary{ formObject.GetDictionary() };
+  if (!formObject.HasStream() ||
+      Resolve(document, dictionary.at(PDFName::Subtype), stream.m_objectIds).GetName() != PDFName::Form ||
+      std::ranges::find(context.m_ancestorIds, formId) != context.m_ancestorIds.end() ||
+      context.m_ancestorIds.size() >= MAX_FORM_DEPTH)
+    return nullptr;
 
-  std::vector<PDFStreamFinder::GraphicsStream> streams;
+  auto form{ std::make_shared<Form>() };
+  form->m_id = formId;
+  form->m_contents = { document.GetDecodedStream(formId), &formObject };
 
-  for (const auto& [objectId, pdfObject] : document.GetObjects())
+  if (float matrix[6]; ReadNumbers(document, dictionary.at(PDFName::Matrix), matrix, stream.m_objectIds))
+    form->m_matrix = CTM{ matrix[0], matrix[2], matrix[4], matrix[1], matrix[3], matrix[5], 0.f, 0.f, 1.f };
+  if (float boundingBox[4]; ReadNumbers(document, dictionary.at(PDFName::BBox), boundingBox, stream.m_objectIds))
   {
-    if (pdfObject.IsDictionary() && pdfObject.GetDictionary().contains("MediaBox"))
+    // Any two opposite corners are allowed
+    form->m_boundingBox =
+      Rectangle{ { std::min(boundingBox[0], boundingBox[2]), std::min(boundingBox[1], boundingBox[3]) },
+                 { std::max(boundingBox[0], boundingBox[2]), std::max(boundingBox[1], boundingBox[3]) } };
+  }
+
+  context.m_ancestorIds.push_back(formId);
+  form->m_forms =
+    CreateForms(document, Resolve(document, dictionary.at(PDFName::Resources), stream.m_objectIds), context, stream);
+  context.m_ancestorIds.pop_back();
+
+  context.m_createdForms.emplace(formId, form);
+  return form;
+}
+
+PDFStreamFinder::GraphicsStream PDFStreamFinder::CreateGraphicsStream(const PDFDocument& document,
+                                                                      const PDFPageTree::Page& page)
+{
+  GraphicsStream stream{ {}, page.m_cropBox, page.m_objectId, page.m_objectIds, {} };
+  auto AddContents{ [&](const PDFObject& streamObjectReference)
+  {
+    const PDFObject& streamObject{ GetObject(document, streamObjectReference.GetReference(), stream.m_objectIds) };
+    stream.m_contents.push_back({ document.GetDecodedStream(streamObjectReference.GetReference()), &streamObject });
+  } };
+
+  // /Contents may also be a reference to an array of references
+  auto contents{ page.m_dictionary.GetDictionary().at(PDFName::Contents) };
+  if (contents.IsReference() && document.Resolve(contents).IsArray())
+    contents = Resolve(document, contents, stream.m_objectIds);
+
+  if (contents.IsReference())
+  {
+    AddContents(contents);
+  }
+  else if (contents.IsArray())
+  {
+    for (auto& arrayEntry : contents.GetArray())
     {
-      const auto& mediaBoxArray{ pdfObject.GetDictionary().at("MediaBox").GetArray() };
-      Rectangle mediaBox;
-      mediaBox.min.x = static_cast<float>(mediaBoxArray[0].GetDecimalOrInt());
-      mediaBox.min.y = static_cast<float>(mediaBoxArray[1].GetDecimalOrInt());
-      mediaBox.max.x = static_cast<float>(mediaBoxArray[2].GetDecimalOrInt());
-      mediaBox.max.y = static_cast<float>(mediaBoxArray[3].GetDecimalOrInt());
-
-      if (pdfObject.GetDictionary().at("Type").GetName() == "Page")
-      {
-        auto AddToStream{ [&](const PDFObject& streamObjectReference)
-        {
-          const PDFObject& streamObject{ document.GetObjects().at(streamObjectReference.GetReference()) };
-          streams.push_back(GraphicsStream{ streamObject.GetStream(), mediaBox });
-        } };
-
-        auto contents{ pdfObject.GetDictionary().at("Contents") };
-        if (contents.IsReference())
-        {
-          AddToStream(contents);
-        }
-        else if (contents.IsArray())
-        {
-          for (auto& arrayEntry : contents.GetArray())
-          {
-            AddToStream(arrayEntry);
-          }
-        }
-      }
+      AddContents(arrayEntry);
     }
   }
 
+  // Forms painted from several places of the page share their object
+  FormContext formContext;
+  stream.m_forms = CreateForms(document, page.m_resources, formContext, stream);
+
+  std::ranges::sort(stream.m_objectIds);
+  stream.m_objectIds.erase(std::unique(stream.m_objectIds.begin(), stream.m_objectIds.end()), stream.m_objectIds.end());
+  return stream;
+}
+
+std::vector<PDFStreamFinder::GraphicsStream> PDFStreamFinder::CreateGraphicsStreams(
+  const PDFDocument& document,
+  const std::vector<PDFPageTree::Page>& pages)
+{
+  // The content streams of the pages are parsed and decoded in parallel
+  std::vector<GraphicsStream> streams(pages.size());
+  std::ranges::iota_view pageIndexView{ 0, static_cast<int>(pages.size()) };
+  std::for_each(std::execution::par,
+                pageIndexView.begin(),
+                pageIndexView.end(),
+                [&](int pageIndex) { streams[pageIndex] = CreateGraphicsStream(document, pages[pageIndex]); });
   return streams;
 }
+
+std::vector<PDFStreamFinder::GraphicsStream> PDFStreamFinder::GetGraphicsStreams(const PDFDocument& document) const
+{
+  return CreateGraphicsStreams(document, PDFPageTree{ document }.GetPages());
+}
+
+std::vector<PDFStreamFinder::GraphicsStream> PDFStreamFinder::GetGraphicsStreams(const PDFDocument& document,
+                                                                                 size_t firstPageIndex,
+                                                                                 size_t pageCount) const
+{
+  // Looking up every page on its own would descend from the root and count the kids before it for each of them
+  PDFPageTree pageTree{ document };
+  if (firstPageIndex >= pageTree.GetPageCount())
+    return {};
+  return CreateGraphicsStreams(document, pageTree.GetPages(firstPageIndex, pageCount));
+}
+
+std::vector<PDFStreamFinder::GraphicsStream> PDFStreamFinder::GetGraphicsStreams(
+  const PDFDocument& document,
+  const std::vector<PDFObject::ID>& pageIds) const
+{
+  const std::unordered_set<PDFObject::ID> requestedPageIds{ pageIds.begin(), pageIds.end() };
+  std::vector<PDFPageTree::Page> pages{ PDFPageTree{ document }.GetPages() };
+  std::erase_if(pages, [&](const PDFPageTree::Page& page) { return !requestedPageIds.contains(page.m_objectId); });
+  return CreateGraphicsStreams(document, pages);
+}
@@ -1,18 +1,86 @@
 #pragma once
 
+#include "GraphicsState.hpp"
+#include "PDFObject.hpp"
+#include "PDFPageTree.hpp"
 #include "math/Rectangle.hpp"
-#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+class PDFDocument;
+
 class PDFStreamFinder
 {
 public:
+  struct Form;
+
+  // Content stream which is either decoded and shared with the stream cache, or decoded while it is read because it is
+  // larger than the whole budget of the cache
+  struct Contents
+  {
+    std::shared_ptr<const std::string> m_data; // nullptr if the stream is decoded while it is read
+    const PDFObject* m_streamObject{ nullptr };
+  };
+
+  // Form XObjects of a resource dictionary by their resource name
+  using Forms = std::map<std::string, std::shared_ptr<const Form>, std::less<>>;
+
+  // Form XObject, a content stream which the Do operator paints as a part of the page
+  struct Form
+  {
+    PDFObject::ID m_id{ -1 };
+    Contents m_contents;
+    CTM m_matrix{ CTM::Identity() }; // From the space of the form to the space it is painted in
+    std::optional<Rectangle> m_boundingBox;
+    Forms m_forms; // Of its own resources
+  };
+
+  // Content of a single page
   struct GraphicsStream
   {
-    std::string m_data;
+    std::vector<Contents> m_contents; // In order
     Rectangle m_drawArea;
+    PDFObject::ID m_pageId;
+    std::vector<PDFObject::ID> m_objectIds; // Every object the content was built from, sorted
+    Forms m_forms;
   };
 
-  std::vector<GraphicsStream> GetGraphicsStreams(const std::filesystem::path& sourceFile) const;
+private:
+  // Forms which were already created for a page, and the forms which are being created, to skip forms which contain
+  // themselves
+  struct FormContext
+  {
+    std::unordered_map<PDFObject::ID, std::shared_ptr<const Form>> m_createdForms;
+    std::vector<PDFObject::ID> m_ancestorIds;
+  };
+
+  static Forms CreateForms(const PDFDocument& document,
+                           const PDFObject& resources,
+                           FormContext& context,
+                           GraphicsStream& stream);
+  static std::shared_ptr<const Form> CreateForm(const PDFDocument& document,
+                                                PDFObject::ID formId,
+                                                FormContext& context,
+                                                GraphicsStream& stream);
+  static GraphicsStream CreateGraphicsStream(const PDFDocument& document, const PDFPageTree::Page& page);
+  static std::vector<GraphicsStream> CreateGraphicsStreams(const PDFDocument& document,
+                                                           const std::vector<PDFPageTree::Page>& pages);
+
+public:
+  // Content of all pages in document order
+  std::vector<GraphicsStream> GetGraphicsStreams(const PDFDocument& document) const;
+  // Content of the pages [firstPageIndex, firstPageIndex + pageCount), clamped to the pages of the document. Only the
+  // page tree nodes leading to the first page and the nodes of the pages after it are parsed.
+  std::vector<GraphicsStream> GetGraphicsStreams(const PDFDocument& document,
+                                                 size_t firstPageIndex,
+                                                 size_t pageCount) const;
+  // Content of the pages with the given object IDs in document order, IDs of other objects are ignored. The page tree
+  // is walked as a whole, but only the content of these pages is decoded.
+  std::vector<GraphicsStream> GetGraphicsStreams(const PDFDocument& document,
+                                                 const std::vector<PDFObject::ID>& pageIds) const;
 };
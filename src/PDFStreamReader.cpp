@@ -1,270 +1,541 @@
 #include "PDFStreamReader.hpp"
-#include <execution>
+#include "PDFFilter.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
-#include <ranges>
 
 namespace
 {
-bool IsNumber(std::string_view token)
+// Streams which are larger than the stream cache are decoded and read in windows of this size, which are large enough
+// to be tokenized in parallel
+constexpr size_t STREAM_WINDOW_SIZE{ 4 << 20 };
+
+// Operators have at most three characters, packed into an integer they can be dispatched with a switch
+constexpr uint32_t PackOperator(std::string_view token)
 {
-  return token.find_first_not_of("0123456789.-") == std::string::npos;
+  if (token.empty() || token.size() > 3)
+    return 0;
+
+  uint32_t packedOperator{ 0 };
+  for (char character : token)
+    packedOperator = packedOperator << 8 | static_cast<uint8_t>(character);
+  return packedOperator;
 }
-} // namespace
 
-PDFStreamReader::PDFStreamReader()
+// Arrays and dictionaries are a single operand with the text between their delimiters, their elements are tokenized
+// again by the operators which use them
+template<typename Lexer>
+std::string_view ReadCompositeOperand(Lexer& lexer, std::string_view begin, std::string_view contents)
 {
-  m_graphicStates.emplace(); // Need to start with one graphics state on the stack
+  const char* const textStart{ begin.data() + begin.size() };
+  int depth{ 1 };
+  for (auto token{ lexer.Next() }; token.m_type != PDFContentLexer::Token::Type::End; token = lexer.Next())
+  {
+    switch (token.m_type)
+    {
+      case PDFContentLexer::Token::Type::ArrayBegin:
+      case PDFContentLexer::Token::Type::DictionaryBegin:
+        depth++;
+        break;
+      case PDFContentLexer::Token::Type::ArrayEnd:
+      case PDFContentLexer::Token::Type::DictionaryEnd:
+        if (--depth == 0)
+          return { textStart, token.m_text.data() };
+        break;
+      default:
+        break;
+    }
+  }
+  // Unterminated, the operand takes the rest of the stream
+  return { textStart, contents.data() + contents.size() };
 }
+} // namespace
 
 void PDFStreamReader::Read(const PDFStreamFinder::GraphicsStream& data)
 {
-  m_readPosition = 0;
-  m_drawArea = data.m_drawArea; // TODO: Draw area should not be per stream if there are multiple streams
-  m_data = data.m_data;
+  m_drawArea = data.m_drawArea;
+  m_forms = &data.m_forms;
+  if (!m_tessellator)
+    m_tessellator.emplace();
+  // The content streams of a page behave like a single stream, operands and state carry over to the next one
+  std::vector<std::string> windows;
+  for (const auto& contents : data.m_contents)
+    windows.push_back(ReadContents(contents));
+  // Operands left at the end of the page can point into the windows
+  m_operands.Clear();
+}
 
+std::string PDFStreamReader::ReadContents(const PDFStreamFinder::Contents& contents)
+{
+  if (contents.m_data)
+  {
+    ReadContents(*contents.m_data);
+    return {};
+  }
+
+  // The operator at the end of a window can continue in the next one, the window is filled up again after the last
+  // complete operator. A window without one is enlarged.
+  PDFStreamDecoder decoder{ *contents.m_streamObject };
+  std::string window(STREAM_WINDOW_SIZE, '\0');
+  size_t size{ 0 };
+  bool lastPart{ false };
   while (true)
   {
-    std::string_view token = NextToken();
-    if (token.empty())
-      break;
-    // std::cout << "token: " << token << "\n";
-    if (IsNumber(token))
-    {
-      std::string copy{ token };
-      m_stack.push(std::stof(copy));
-    }
-    else if (token == "q")
-    {
-      if (m_graphicStates.empty())
-      {
-        m_graphicStates.emplace();
-      }
-      else
-      {
-        GraphicsState copy{ m_graphicStates.top() };
-        m_graphicStates.push(copy);
-      }
-    }
-    else if (token == "Q")
-    {
-      m_graphicStates.pop();
-      if (m_graphicStates.empty()) // TODO: Not sure why this happens
-        m_graphicStates.emplace();
-    }
-    else if (token == "m")
-    {
-      m_currentPath.AddNewSubPath();
-      m_currentPath.AddPoint(PopVector2());
-    }
-    else if (token == "l")
-    {
-      m_currentPath.AddPoint(PopVector2());
-    }
-    else if (token == "c")
-    {
-      Vector2 xy3{ PopVector2() };
-      Vector2 xy2{ PopVector2() };
-      Vector2 xy1{ PopVector2() };
-      m_currentPath.AddBezierCurve(xy1, xy2, xy3);
-    }
-    else if (token == "v")
-    {
-      Vector2 xy3{ PopVector2() };
-      Vector2 xy2{ PopVector2() };
-      m_currentPath.AddBezierCurveDuplicateStartPoint(xy2, xy3);
-    }
-    else if (token == "y")
+    while (size < window.size() && !lastPart)
     {
-      Vector2 xy3{ PopVector2() };
-      Vector2 xy1{ PopVector2() };
-      m_currentPath.AddBezierCurve(xy1, xy3, xy3);
+      const size_t decodedSize{ decoder.Read(window.data() + size, window.size() - size) };
+      lastPart = decodedSize == 0;
+      size += decodedSize;
     }
-    else if (token == "re")
-    {
-      Vector4 rectangle{ PopVector4() };
-      m_currentPath.AddNewSubPath();
-      m_currentPath.AddPoint({ rectangle.x, rectangle.y });
-      m_currentPath.AddPoint({ rectangle.x + rectangle.z, rectangle.y });
-      m_currentPath.AddPoint({ rectangle.x + rectangle.z, rectangle.y + rectangle.w });
-      m_currentPath.AddPoint({ rectangle.x, rectangle.y + rectangle.w });
-      m_currentPath.CloseSubPath();
-    }
-    else if (token == "h")
-    {
-      m_currentPath.CloseSubPath();
-    }
-    else if (token == "j")
-    {
-      GetGraphicsState().SetLineJoinStyle(static_cast<LineJoinStyle>(PopInt()));
-    }
-    else if (token == "J")
-    {
-      GetGraphicsState().SetLineCapStyle(static_cast<LineCapStyle>(PopInt()));
-    }
-    else if (token == "S")
-    {
-      m_currentPath.AddPathMode(PathMode::Stroke);
-      m_paths.emplace_back(std::move(m_currentPath), GetGraphicsState());
-      m_currentPath = Path{};
-    }
-    else if (token == "s")
-    {
-      m_currentPath.CloseSubPath();
-      m_currentPath.AddPathMode(PathMode::Stroke);
-      m_paths.emplace_back(std::move(m_currentPath), GetGraphicsState());
-      m_currentPath = Path{};
-    }
-    else if (token == "b")
-    {
-      m_currentPath.CloseSubPath();
-      m_currentPath.AddPathMode(PathMode::Fill);
-      m_currentPath.AddPathMode(PathMode::Stroke);
-      m_paths.emplace_back(std::move(m_currentPath), GetGraphicsState());
-      m_currentPath = Path{};
-    }
-    else if (token == "f")
-    {
-      m_currentPath.AddPathMode(PathMode::Fill);
-      m_paths.emplace_back(std::move(m_currentPath), GetGraphicsState());
-      m_currentPath = Path{};
-    }
-    else if (token == "f*")
-    {
-      // TODO: Handle winding order / odd-even rule for fill operations
-      m_currentPath.AddPathMode(PathMode::Fill);
-      m_paths.emplace_back(std::move(m_currentPath), GetGraphicsState());
-      m_currentPath = Path{};
-    }
-    else if (token == "RG")
-    {
-      GetGraphicsState().SetStrokeColor(PopVector3());
-    }
-    else if (token == "rg")
-    {
-      GetGraphicsState().SetFillColor(PopVector3());
-    }
-    else if (token == "K")
-    {
-      GetGraphicsState().SetStrokeColor(CMYKtoRGB(PopVector4()));
-    }
-    else if (token == "k")
+
+    const size_t readSize{ ReadContents({ window.data(), size }, lastPart) };
+    if (lastPart)
+      break;
+    if (readSize == 0)
+      window.resize(window.size() * 2);
+    std::memmove(window.data(), window.data() + readSize, size - readSize);
+    size -= readSize;
+  }
+  window.resize(size);
+  return window;
+}
+
+size_t PDFStreamReader::ReadContents(std::string_view contents, bool lastPart)
+{
+  // Very large streams are tokenized on several threads, only interpreting the tokens is serial
+  if (PDFParallelContentLexer::IsWorthwhile(contents.size()))
+  {
+    PDFParallelContentLexer lexer{ contents };
+    return ReadTokens(lexer, contents, lastPart);
+  }
+  PDFContentLexer lexer{ contents };
+  return ReadTokens(lexer, contents, lastPart);
+}
+
+template<typename Lexer>
+size_t PDFStreamReader::ReadTokens(Lexer& lexer, std::string_view contents, bool lastPart)
+{
+  using Type = PDFContentLexer::Token::Type;
+
+  // A token which reaches the end of a part which is not the last one can continue in the next part. Reading stops
+  // before it, the operands are the empty stack after the last operator or the operands the part started with.
+  const char* const contentsEnd{ contents.data() + contents.size() };
+  auto IsCutOff{ [&](std::string_view text) { return !lastPart && text.data() + text.size() >= contentsEnd; } };
+  std::optional<PDFOperandStack> initialOperands;
+  if (!lastPart)
+    initialOperands = m_operands;
+  size_t readSize{ 0 };
+
+  while (true)
+  {
+    // Constructed in place, assigning the returned token to a variable of the loop costs a copy through memory
+    const PDFContentLexer::Token token{ lexer.Next() };
+    if (token.m_type == Type::End || IsCutOff(token.m_text))
+      break;
+    if (token.m_type == Type::Number)
     {
-      GetGraphicsState().SetFillColor(CMYKtoRGB(PopVector4()));
+      m_operands.PushNumber(token.m_number);
+      continue;
     }
-    else if (token == "w")
+    if (token.m_type != Type::Operator)
     {
-      GetGraphicsState().SetLineWidth(PopFloat());
+      PushOperand(lexer, token, contents);
+      // An array or a dictionary without its end
+      if ((token.m_type == Type::ArrayBegin || token.m_type == Type::DictionaryBegin) &&
+          IsCutOff(m_operands.GetText(0)))
+        break;
+      continue;
     }
-    else if (token == "cm")
+
+    const uint32_t packedOperator{ PackOperator(token.m_text) };
+    switch (packedOperator)
     {
-      // TODO: Append to existing matrix?
-      GetGraphicsState().SetTransform(PopCTM());
+      // Graphics state
+      case PackOperator("q"):
+        m_graphicStates.Save();
+        break;
+      case PackOperator("Q"):
+        m_graphicStates.Restore();
+        break;
+      case PackOperator("cm"):
+        if (const auto operands{ GetOperands(6) }; !operands.empty())
+        {
+          GetGraphicsState().SetTransform(
+            CTM{ operands[0], operands[2], operands[4], operands[1], operands[3], operands[5], 0.f, 0.f, 1.f });
+        }
+        break;
+      case PackOperator("w"):
+        if (const auto operands{ GetOperands(1) }; !operands.empty())
+          GetGraphicsState().SetLineWidth(operands[0]);
+        break;
+      case PackOperator("J"):
+        if (const auto operands{ GetOperands(1) }; !operands.empty())
+          GetGraphicsState().SetLineCapStyle(static_cast<LineCapStyle>(static_cast<int>(operands[0])));
+        break;
+      case PackOperator("j"):
+        if (const auto operands{ GetOperands(1) }; !operands.empty())
+          GetGraphicsState().SetLineJoinStyle(static_cast<LineJoinStyle>(static_cast<int>(operands[0])));
+        break;
+      case PackOperator("M"):  // Miter limit
+      case PackOperator("d"):  // Dash pattern
+      case PackOperator("ri"): // Rendering intent
+      case PackOperator("i"):  // Flatness
+      case PackOperator("gs"): // Graphics state parameter dictionary
+        break;
+
+      // Path construction
+      case PackOperator("m"):
+        if (const auto operands{ GetOperands(2) }; !operands.empty())
+        {
+          m_displayList.MoveTo({ operands[0], operands[1] });
+        }
+        break;
+      case PackOperator("l"):
+        if (const auto operands{ GetOperands(2) }; !operands.empty())
+          m_displayList.LineTo({ operands[0], operands[1] });
+        break;
+      case PackOperator("c"):
+        if (const auto operands{ GetOperands(6) }; !operands.empty())
+        {
+          m_displayList.CurveTo(
+            { operands[0], operands[1] }, { operands[2], operands[3] }, { operands[4], operands[5] });
+        }
+        break;
+      case PackOperator("v"):
+        if (const auto operands{ GetOperands(4) }; !operands.empty())
+          m_displayList.CurveToDuplicateStartPoint({ operands[0], operands[1] }, { operands[2], operands[3] });
+        break;
+      case PackOperator("y"):
+        if (const auto operands{ GetOperands(4) }; !operands.empty())
+        {
+          const Vector2 xy3{ operands[2], operands[3] };
+          m_displayList.CurveTo({ operands[0], operands[1] }, xy3, xy3);
+        }
+        break;
+      case PackOperator("h"):
+        m_displayList.ClosePath();
+        break;
+      case PackOperator("re"):
+        if (const auto operands{ GetOperands(4) }; !operands.empty())
+        {
+          const Vector4 rectangle{ operands[0], operands[1], operands[2], operands[3] };
+          m_displayList.MoveTo({ rectangle.x, rectangle.y });
+          m_displayList.LineTo({ rectangle.x + rectangle.z, rectangle.y });
+          m_displayList.LineTo({ rectangle.x + rectangle.z, rectangle.y + rectangle.w });
+          m_displayList.LineTo({ rectangle.x, rectangle.y + rectangle.w });
+          m_displayList.ClosePath();
+        }
+        break;
+
+      // Path painting
+      // TODO: Handle winding order / odd-even rule for the * variants of the fill operations
+      case PackOperator("S"):
+        PaintPath(false, PathMode::Stroke);
+        break;
+      case PackOperator("s"):
+        PaintPath(true, PathMode::Stroke);
+        break;
+      case PackOperator("f"):
+      case PackOperator("F"):
+      case PackOperator("f*"):
+        PaintPath(false, PathMode::Fill);
+        break;
+      case PackOperator("B"):
+      case PackOperator("B*"):
+        PaintPath(false, PathMode::Fill | PathMode::Stroke);
+        break;
+      case PackOperator("b"):
+      case PackOperator("b*"):
+        PaintPath(true, PathMode::Fill | PathMode::Stroke);
+        break;
+      case PackOperator("n"):
+        EndPath(std::nullopt);
+        break;
+
+      // Clipping paths, the path is still ended by the next painting operator. The clip is the bounding box of the
+      // path, which is exact for rectangles.
+      case PackOperator("W"):
+      case PackOperator("W*"):
+        m_clipPending = true;
+        break;
+
+      // Color, the color spaces are not tracked so the color is interpreted by its number of components
+      case PackOperator("G"):
+        if (const auto operands{ GetOperands(1) }; !operands.empty())
+          GetGraphicsState().SetStrokeColor(Vector3{ operands[0] });
+        break;
+      case PackOperator("g"):
+        if (const auto operands{ GetOperands(1) }; !operands.empty())
+          GetGraphicsState().SetFillColor(Vector3{ operands[0] });
+        break;
+      case PackOperator("RG"):
+        if (const auto operands{ GetOperands(3) }; !operands.empty())
+          GetGraphicsState().SetStrokeColor({ operands[0], operands[1], operands[2] });
+        break;
+      case PackOperator("rg"):
+        if (const auto operands{ GetOperands(3) }; !operands.empty())
+          GetGraphicsState().SetFillColor({ operands[0], operands[1], operands[2] });
+        break;
+      case PackOperator("K"):
+        if (const auto operands{ GetOperands(4) }; !operands.empty())
+          GetGraphicsState().SetStrokeColor(CMYKtoRGB({ operands[0], operands[1], operands[2], operands[3] }));
+        break;
+      case PackOperator("k"):
+        if (const auto operands{ GetOperands(4) }; !operands.empty())
+          GetGraphicsState().SetFillColor(CMYKtoRGB({ operands[0], operands[1], operands[2], operands[3] }));
+        break;
+      case PackOperator("SC"):
+      case PackOperator("SCN"):
+        if (Vector3 color; GetColor(color))
+          GetGraphicsState().SetStrokeColor(color);
+        break;
+      case PackOperator("sc"):
+      case PackOperator("scn"):
+        if (Vector3 color; GetColor(color))
+          GetGraphicsState().SetFillColor(color);
+        break;
+      case PackOperator("CS"):
+      case PackOperator("cs"):
+        break;
+
+      // XObjects, only forms are painted
+      case PackOperator("Do"):
+        if (m_operands.GetSize() > 0 && m_operands.GetType(0) == PDFOperandStack::Type::Name)
+          PaintForm(m_operands.GetText(0));
+        else
+          m_missingOperandCount++;
+        break;
+
+      // Not supported yet: text, images, shadings, inline images, Type 3 fonts, marked content and compatibility
+      // sections
+      case PackOperator("BT"):
+      case PackOperator("ET"):
+      case PackOperator("Tc"):
+      case PackOperator("Tw"):
+      case PackOperator("Tz"):
+      case PackOperator("TL"):
+      case PackOperator("Tf"):
+      case PackOperator("Tr"):
+      case PackOperator("Ts"):
+      case PackOperator("Td"):
+      case PackOperator("TD"):
+      case PackOperator("Tm"):
+      case PackOperator("T*"):
+      case PackOperator("Tj"):
+      case PackOperator("TJ"):
+      case PackOperator("'"):
+      case PackOperator("\""):
+      case PackOperator("sh"):
+      case PackOperator("BI"):
+      case PackOperator("ID"):
+      case PackOperator("EI"):
+      case PackOperator("d0"):
+      case PackOperator("d1"):
+      case PackOperator("MP"):
+      case PackOperator("DP"):
+      case PackOperator("BMC"):
+      case PackOperator("BDC"):
+      case PackOperator("EMC"):
+      case PackOperator("BX"):
+      case PackOperator("EX"):
+        break;
+
+      default:
+        // The keywords true, false and null are operands, other tokens are unknown operators
+        if (token.m_text == "true" || token.m_text == "false" || token.m_text == "null")
+        {
+          m_operands.Push(PDFOperandStack::Type::Keyword, token.m_text);
+          continue;
+        }
+        break;
     }
+
+    // Operands which were not used by the operator
+    m_operands.Clear();
+    // The lexer skips the data of an inline image after ID, reading can only start again after its EI
+    if (packedOperator != PackOperator("ID"))
+      readSize = static_cast<size_t>(token.m_text.data() + token.m_text.size() - contents.data());
+  }
+
+  if (!lastPart)
+  {
+    if (readSize > 0)
+      m_operands.Clear();
     else
-    {
-      // std::cout << "token: " << token << "\n";
-    }
+      m_operands = *initialOperands;
+    return readSize;
   }
+
+  if (m_missingOperandCount > 0)
+  {
+    std::cerr << "Skipped " << m_missingOperandCount << " operators without the expected operands\n";
+    m_missingOperandCount = 0;
+  }
+  return contents.size();
 }
 
-std::vector<Triangle> PDFStreamReader::CollectTriangles() const
+void PDFStreamReader::PaintPath(bool closeSubPath, PathMode pathMode)
 {
-  std::vector<std::vector<Triangle>> perPathTriangles(m_paths.size());
+  if (closeSubPath)
+    m_displayList.ClosePath();
+  EndPath(pathMode);
+}
 
-  std::ranges::iota_view pathIndexView{ 0, static_cast<int>(m_paths.size()) };
-  std::for_each(std::execution::par,
-                pathIndexView.begin(),
-                pathIndexView.end(),
-                [&](int pathIndex)
+void PDFStreamReader::EndPath(std::optional<PathMode> pathMode)
+{
+  // The path is painted without the clip it sets, which only applies to the following paths
+  std::optional<Rectangle> clip;
+  if (std::exchange(m_clipPending, false))
+    clip = m_displayList.GetCurrentPathBounds();
+
+  if (pathMode)
   {
-    const auto& [path, graphicsState]{ m_paths[pathIndex] };
-    // Cannot write to return value directly because the order of paths must be preserved
-    perPathTriangles[pathIndex].reserve(path.GetApproximateTriangleCount());
-    path.GetTriangles(graphicsState, perPathTriangles[pathIndex]);
-  });
-
-  size_t triangleCount{ 0 };
-  for (const auto& pathTriangles : perPathTriangles)
-    triangleCount += pathTriangles.size();
-
-  std::vector<Triangle> triangles;
-  triangles.reserve(triangleCount);
-  for (const auto& pathTriangles : perPathTriangles)
-    triangles.insert(triangles.end(), pathTriangles.begin(), pathTriangles.end());
-
-  return triangles;
+    m_displayList.PaintPath(m_graphicStates.GetCurrent(), *pathMode);
+    if (m_tessellator)
+      m_tessellator->Update(m_displayList);
+  }
+  else
+    m_displayList.DiscardPath();
+
+  if (clip)
+    GetGraphicsState().IntersectClip(m_graphicStates.GetCurrent().Transform(*clip));
 }
 
-const Rectangle& PDFStreamReader::GetDrawArea() const
+void PDFStreamReader::PaintForm(std::string_view name)
 {
-  return m_drawArea;
+  // Images and XObjects which are not in the resources are skipped
+  if (m_forms == nullptr)
+    return;
+  const auto formIt{ m_forms->find(name) };
+  if (formIt == m_forms->end())
+    return;
+  const PDFStreamFinder::Form& form{ *formIt->second };
+
+  // Only the state without the transform and the clip decides whether a recording of the form can be painted again,
+  // the clip is applied to the placement. The transform is a part of the placement, so placements with different
+  // transforms share their state.
+  GraphicsState placementState{ m_graphicStates.GetCurrent() };
+  placementState.ResetTransform();
+  GraphicsState formState{ placementState };
+  formState.ResetClip();
+  auto& recordings{ m_recordedForms[form.m_id] };
+  auto recording{ std::ranges::find_if(recordings, [&](const auto& entry) { return entry.first == formState; }) };
+  if (recording == recordings.end())
+  {
+    auto recordedForm{ RecordForm(form, formState) };
+    recording = recordings.emplace(recordings.end(), formState, std::move(recordedForm));
+  }
+
+  m_displayList.PaintForm(
+    placementState, recording->second, m_graphicStates.GetCurrent().GetTransform() * form.m_matrix);
 }
 
-std::string_view PDFStreamReader::NextToken()
+std::shared_ptr<const PDFDisplayList> PDFStreamReader::RecordForm(const PDFStreamFinder::Form& form,
+                                                                  const GraphicsState& formState)
 {
-  size_t startRead{ m_readPosition };
-  while (m_readPosition < m_data.size() && m_data[m_readPosition] != ' ' && m_data[m_readPosition] != '\n' &&
-         m_data[m_readPosition] != '\r')
-    m_readPosition++;
-  if (m_readPosition == m_data.size())
-    return {};
-  size_t endRead{ m_readPosition };
-  while (m_readPosition < m_data.size() &&
-         (m_data[m_readPosition] == ' ' || m_data[m_readPosition] == '\n' || m_data[m_readPosition] == '\r'))
-    m_readPosition++;
-  return std::string_view(m_data.data() + startRead, endRead - startRead);
+  // The form is read like a page of its own, with its resources and a separate stack of graphics states which an
+  // unbalanced Q in the form cannot pop
+  PDFDisplayList outerDisplayList{ std::exchange(m_displayList, PDFDisplayList{}) };
+  GraphicsStateStack outerGraphicStates{ std::exchange(m_graphicStates, GraphicsStateStack{ formState }) };
+  const PDFStreamFinder::Forms* outerForms{ std::exchange(m_forms, &form.m_forms) };
+  // Forms are tessellated when the page is, in their own space
+  std::optional<PDFTessellator> outerTessellator{ std::exchange(m_tessellator, std::nullopt) };
+  const bool outerClipPending{ std::exchange(m_clipPending, false) };
+  if (form.m_boundingBox)
+    m_displayList.SetBoundingBox(*form.m_boundingBox);
+
+  m_operands.Clear();
+  ReadContents(form.m_contents);
+
+  auto recordedForm{ std::make_shared<const PDFDisplayList>(std::move(m_displayList)) };
+  m_displayList = std::move(outerDisplayList);
+  m_graphicStates = std::move(outerGraphicStates);
+  m_forms = outerForms;
+  m_tessellator = std::move(outerTessellator);
+  m_clipPending = outerClipPending;
+  return recordedForm;
 }
 
-GraphicsState& PDFStreamReader::GetGraphicsState()
+PageTriangles PDFStreamReader::CollectTriangles()
 {
-  return m_graphicStates.top();
+  // A later Read starts over with all paths of the display list, so the next call returns the triangles of all of them
+  PageTriangles pageTriangles{ m_tessellator ? m_tessellator->Finish(m_displayList)
+                                             : m_displayList.CollectTriangles() };
+  m_tessellator.reset();
+  return pageTriangles;
 }
 
-float PDFStreamReader::PopFloat()
+const PDFDisplayList& PDFStreamReader::GetDisplayList() const
 {
-  float ret{ m_stack.top() };
-  m_stack.pop();
-  return ret;
+  return m_displayList;
 }
 
-int PDFStreamReader::PopInt()
+const Rectangle& PDFStreamReader::GetDrawArea() const
 {
-  return static_cast<int>(PopFloat());
+  return m_drawArea;
 }
 
-Vector2 PDFStreamReader::PopVector2()
+template<typename Lexer>
+void PDFStreamReader::PushOperand(Lexer& lexer, const PDFContentLexer::Token& token, std::string_view contents)
 {
-  float y{ PopFloat() };
-  float x{ PopFloat() };
-  return Vector2{ x, y };
+  using Type = PDFContentLexer::Token::Type;
+
+  switch (token.m_type)
+  {
+    case Type::Name:
+      m_operands.Push(PDFOperandStack::Type::Name, token.m_text);
+      break;
+    case Type::String:
+      m_operands.Push(PDFOperandStack::Type::String, token.m_text);
+      break;
+    case Type::HexString:
+      m_operands.Push(PDFOperandStack::Type::HexString, token.m_text);
+      break;
+    case Type::ArrayBegin:
+      m_operands.Push(PDFOperandStack::Type::Array, ReadCompositeOperand(lexer, token.m_text, contents));
+      break;
+    case Type::DictionaryBegin:
+      m_operands.Push(PDFOperandStack::Type::Dictionary, ReadCompositeOperand(lexer, token.m_text, contents));
+      break;
+    default:
+      // Array or dictionary end without a matching begin
+      break;
+  }
 }
 
-Vector3 PDFStreamReader::PopVector3()
+GraphicsState& PDFStreamReader::GetGraphicsState()
 {
-  float z{ PopFloat() };
-  float y{ PopFloat() };
-  float x{ PopFloat() };
-  return Vector3{ x, y, z };
+  return m_graphicStates.ModifyCurrent();
 }
 
-Vector4 PDFStreamReader::PopVector4()
+std::span<const float> PDFStreamReader::GetOperands(size_t count)
 {
-  float w{ PopFloat() };
-  float z{ PopFloat() };
-  float y{ PopFloat() };
-  float x{ PopFloat() };
-  return Vector4{ x, y, z, w };
+  const std::span<const float> operands{ m_operands.GetNumbers(count) };
+  if (operands.empty())
+    m_missingOperandCount++;
+  return operands;
 }
 
-CTM PDFStreamReader::PopCTM()
+bool PDFStreamReader::GetColor(Vector3& color)
 {
-  float f{ PopFloat() };
-  float e{ PopFloat() };
-  float d{ PopFloat() };
-  float c{ PopFloat() };
-  float b{ PopFloat() };
-  float a{ PopFloat() };
-  return CTM{ a, c, e, b, d, f, 0.f, 0.f, 1.f };
+  const size_t componentCount{ m_operands.GetNumberCount() };
+  const std::span<const float> components{ m_operands.GetNumbers(componentCount) };
+  switch (componentCount)
+  {
+    case 1:
+      color = Vector3{ components[0] };
+      return true;
+    case 3:
+      color = Vector3{ components[0], components[1], components[2] };
+      return true;
+    case 4:
+      color = CMYKtoRGB({ components[0], components[1], components[2], components[3] });
+      return true;
+    default:
+      // Patterns and color spaces with other numbers of components
+      return false;
+  }
 }
 
 Vector3 PDFStreamReader::CMYKtoRGB(const Vector4& cmyk)
@@ -1,36 +1,69 @@
 #pragma once
 
+#include "GraphicsStateStack.hpp"
+#include "PDFContentLexer.hpp"
+#include "PDFDisplayList.hpp"
+#include "PDFOperandStack.hpp"
+#include "PDFParallelContentLexer.hpp"
 #include "PDFStreamFinder.hpp"
+#include "PDFTessellator.hpp"
+#include "PageTriangles.hpp"
 #include "Path.hpp"
 #include "math/Vector.hpp"
-#include <stack>
+#include <memory>
+#include <optional>
+#include <span>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 class PDFStreamReader
 {
-  std::string m_data;
   Rectangle m_drawArea;
-  size_t m_readPosition{ 0 };
-  std::stack<float> m_stack;
+  PDFOperandStack m_operands;
+  size_t m_missingOperandCount{ 0 };
+  bool m_clipPending{ false }; // W or W* was read, the current path becomes the clip when it is ended
 
-  std::string_view NextToken();
+  // Returns the last window of a stream which was decoded while it was read, the operands left at its end point into it
+  std::string ReadContents(const PDFStreamFinder::Contents& contents);
+  // Unless contents is the last part of a stream, reading stops after the last operator which is complete in contents.
+  // Returns the size of the part which was read, the rest has to be read again with the next part.
+  size_t ReadContents(std::string_view contents, bool lastPart = true);
+  // Interprets the tokens of a PDFContentLexer or a PDFParallelContentLexer
+  template<typename Lexer>
+  size_t ReadTokens(Lexer& lexer, std::string_view contents, bool lastPart);
+  template<typename Lexer>
+  void PushOperand(Lexer& lexer, const PDFContentLexer::Token& token, std::string_view contents);
+  // The current graphics state for changing it
   GraphicsState& GetGraphicsState();
-  float PopFloat();
-  int PopInt();
-  Vector2 PopVector2();
-  Vector3 PopVector3();
-  Vector4 PopVector4();
-  CTM PopCTM();
+  // The topmost count operands if they are numbers, otherwise the operator is skipped
+  std::span<const float> GetOperands(size_t count);
+  // Gray, RGB or CMYK depending on the number of operands
+  bool GetColor(Vector3& color);
   static Vector3 CMYKtoRGB(const Vector4& cmyk);
+  void PaintPath(bool closeSubPath, PathMode pathMode);
+  // Paints the current path, or discards it without a mode, and makes it the clip if W or W* was read
+  void EndPath(std::optional<PathMode> pathMode);
+  void PaintForm(std::string_view name);
+  std::shared_ptr<const PDFDisplayList> RecordForm(const PDFStreamFinder::Form& form, const GraphicsState& formState);
 
-  Path m_currentPath;
-  std::vector<std::pair<Path, GraphicsState>> m_paths;
-  std::stack<GraphicsState> m_graphicStates;
+  PDFDisplayList m_displayList;
+  std::optional<PDFTessellator> m_tessellator; // Tessellates the paths of the display list while they are read
+  GraphicsStateStack m_graphicStates;
+  const PDFStreamFinder::Forms* m_forms{ nullptr }; // Of the content which is read
+  // Forms are recorded in their own space, once for each graphics state they are painted with
+  std::unordered_map<PDFObject::ID, std::vector<std::pair<GraphicsState, std::shared_ptr<const PDFDisplayList>>>>
+    m_recordedForms;
 
 public:
-  PDFStreamReader();
+  // Interprets the content streams of a page, the reader keeps the paths of all pages it has read
   void Read(const PDFStreamFinder::GraphicsStream& data);
 
-  std::vector<Triangle> CollectTriangles() const;
+  // Waits for the paths which were read to be tessellated
+  PageTriangles CollectTriangles();
+  // The paths of all pages which were read, for caching them or replaying them without interpreting the streams again
+  const PDFDisplayList& GetDisplayList() const;
   const Rectangle& GetDrawArea() const;
 };
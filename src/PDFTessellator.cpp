@@ -0,0 +1,379 @@
+#include "PDFTessellator.hpp"
+#include "Path.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <execution>
+#include <ranges>
+
+namespace
+{
+Vector2 TransformPoint(const CTM& transform, const Vector2& point)
+{
+  Vector3 result{ transform * Vector3{ point.x, point.y, 1.f } };
+  return { result.x / result.z, result.y / result.z };
+}
+
+Triangle TransformTriangle(const CTM& transform, Triangle triangle)
+{
+  triangle.a.position = TransformPoint(transform, triangle.a.position);
+  triangle.b.position = TransformPoint(transform, triangle.b.position);
+  triangle.c.position = TransformPoint(transform, triangle.c.position);
+  return triangle;
+}
+
+Rectangle TransformRectangle(const CTM& transform, const Rectangle& rectangle)
+{
+  const Vector2 corners[]{ TransformPoint(transform, rectangle.min),
+                           TransformPoint(transform, Vector2{ rectangle.max.x, rectangle.min.y }),
+                           TransformPoint(transform, rectangle.max),
+                           TransformPoint(transform, Vector2{ rectangle.min.x, rectangle.max.y }) };
+  Rectangle bounds{ corners[0], corners[0] };
+  for (const Vector2& corner : corners)
+  {
+    bounds.min = { std::min(bounds.min.x, corner.x), std::min(bounds.min.y, corner.y) };
+    bounds.max = { std::max(bounds.max.x, corner.x), std::max(bounds.max.y, corner.y) };
+  }
+  return bounds;
+}
+
+std::optional<Rectangle> GetBounds(const std::vector<Triangle>& triangles)
+{
+  std::optional<Rectangle> bounds;
+  for (const Triangle& triangle : triangles)
+  {
+    for (const Vector2& point : { triangle.a.position, triangle.b.position, triangle.c.position })
+    {
+      if (!bounds)
+        bounds = Rectangle{ point, point };
+      bounds->min = { std::min(bounds->min.x, point.x), std::min(bounds->min.y, point.y) };
+      bounds->max = { std::max(bounds->max.x, point.x), std::max(bounds->max.y, point.y) };
+    }
+  }
+  return bounds;
+}
+
+// Content which only touches the clip covers none of its area, nothing is inside of an empty clip
+bool IsOutside(const Rectangle& bounds, const Rectangle& clip)
+{
+  return clip.min.x >= clip.max.x || clip.min.y >= clip.max.y || bounds.max.x <= clip.min.x ||
+         bounds.min.x >= clip.max.x || bounds.max.y <= clip.min.y || bounds.min.y >= clip.max.y;
+}
+
+bool IsInside(const Rectangle& bounds, const Rectangle& clip)
+{
+  return bounds.min.x >= clip.min.x && bounds.max.x <= clip.max.x && bounds.min.y >= clip.min.y &&
+         bounds.max.y <= clip.max.y;
+}
+
+bool IsInside(const Triangle& triangle, const Rectangle& clip)
+{
+  return std::ranges::all_of(std::array{ triangle.a.position, triangle.b.position, triangle.c.position },
+                             [&](const Vector2& point)
+  { return point.x >= clip.min.x && point.x <= clip.max.x && point.y >= clip.min.y && point.y <= clip.max.y; });
+}
+
+// Cuts the triangle at the edges of the clip with Sutherland-Hodgman, the convex polygon which is left is added as a
+// fan of triangles
+void ClipTriangle(const Triangle& triangle, const Rectangle& clip, std::vector<Triangle>& trianglesOut)
+{
+  // Every edge adds at most one point to a convex polygon, the spare points absorb rounding
+  std::array<Vector2, 12> polygon{ triangle.a.position, triangle.b.position, triangle.c.position };
+  size_t pointCount{ 3 };
+  auto ClipEdge{ [&](auto distance)
+  {
+    const std::array<Vector2, 12> input{ polygon };
+    const size_t inputCount{ std::exchange(pointCount, 0) };
+    for (size_t pointIndex{ 0 }; pointIndex < inputCount && pointCount + 2 <= polygon.size(); ++pointIndex)
+    {
+      const Vector2& point{ input[pointIndex] };
+      const Vector2& nextPoint{ input[(pointIndex + 1) % inputCount] };
+      const float pointDistance{ distance(point) };
+      const float nextPointDistance{ distance(nextPoint) };
+      if (pointDistance >= 0.f)
+        polygon[pointCount++] = point;
+      if ((pointDistance >= 0.f) != (nextPointDistance >= 0.f))
+        polygon[pointCount++] = point + (nextPoint - point) * (pointDistance / (pointDistance - nextPointDistance));
+    }
+  } };
+  ClipEdge([&](const Vector2& point) { return point.x - clip.min.x; });
+  ClipEdge([&](const Vector2& point) { return clip.max.x - point.x; });
+  ClipEdge([&](const Vector2& point) { return point.y - clip.min.y; });
+  ClipEdge([&](const Vector2& point) { return clip.max.y - point.y; });
+
+  // The vertices of a triangle have the same color
+  for (size_t pointIndex{ 2 }; pointIndex < pointCount; ++pointIndex)
+    trianglesOut.push_back(Triangle{ polygon[0], polygon[pointIndex - 1], polygon[pointIndex], triangle.a.color });
+}
+
+// Returns the number of triangles which were outside of the clip as a whole
+size_t ClipTriangles(std::vector<Triangle>& triangles, const Rectangle& clip)
+{
+  if (std::ranges::all_of(triangles, [&](const Triangle& triangle) { return IsInside(triangle, clip); }))
+    return 0;
+
+  std::vector<Triangle> clippedTriangles;
+  clippedTriangles.reserve(triangles.size());
+  size_t culledTriangleCount{ 0 };
+  for (const Triangle& triangle : triangles)
+  {
+    if (IsInside(triangle, clip))
+    {
+      clippedTriangles.push_back(triangle);
+      continue;
+    }
+    const size_t clippedTriangleCount{ clippedTriangles.size() };
+    ClipTriangle(triangle, clip, clippedTriangles);
+    if (clippedTriangles.size() == clippedTriangleCount)
+      culledTriangleCount++;
+  }
+  triangles = std::move(clippedTriangles);
+  return culledTriangleCount;
+}
+} // namespace
+
+PDFTessellator::PDFTessellator()
+  : m_formTriangles(std::make_shared<FormTriangles>())
+{
+}
+
+PDFTessellator::PDFTessellator(std::shared_ptr<FormTriangles> formTriangles)
+  : m_formTriangles(std::move(formTriangles))
+{
+}
+
+void PDFTessellator::Update(const PDFDisplayList& displayList)
+{
+  if (displayList.GetPaintedPathCount() - m_replayedPathCount < BATCH_PATH_COUNT)
+    return;
+
+  // Batches which are done are added right away to release their memory, the oldest batch is waited for when too many
+  // are in flight
+  while (!m_batches.empty() && m_batches.front().wait_for(std::chrono::seconds{ 0 }) == std::future_status::ready)
+    AddOldestBatch(displayList);
+  while (m_batches.size() >= MAX_BATCHES_IN_FLIGHT)
+    AddOldestBatch(displayList);
+
+  PathStore paths;
+  std::vector<GraphicsState> states;
+  std::vector<PDFDisplayList::FormPlacement> formPlacements;
+  displayList.Replay(paths, states, formPlacements, m_position);
+  m_replayedPathCount = displayList.GetPaintedPathCount();
+  m_batches.push_back(std::async(std::launch::async,
+                                 [paths{ std::move(paths) },
+                                  states{ std::move(states) },
+                                  formPlacements{ std::move(formPlacements) }]() mutable
+  { return Tessellate(paths, states, std::move(formPlacements)); }));
+}
+
+PageTriangles PDFTessellator::Finish(const PDFDisplayList& displayList)
+{
+  while (!m_batches.empty())
+    AddOldestBatch(displayList);
+
+  // The last paths are tessellated on this thread, for small pages they are all of them
+  PathStore paths;
+  std::vector<GraphicsState> states;
+  std::vector<PDFDisplayList::FormPlacement> formPlacements;
+  displayList.Replay(paths, states, formPlacements, m_position);
+  m_replayedPathCount = displayList.GetPaintedPathCount();
+  AddBatch(displayList, Tessellate(paths, states, std::move(formPlacements)));
+
+  AddFormsPaintedOnce();
+  return std::exchange(m_pageTriangles, {});
+}
+
+PDFTessellator::Batch PDFTessellator::Tessellate(const PathStore& paths,
+                                                 const std::vector<GraphicsState>& states,
+                                                 std::vector<PDFDisplayList::FormPlacement>&& formPlacements)
+{
+  Batch batch{ std::vector<std::vector<Triangle>>(paths.GetPathCount()), std::move(formPlacements) };
+  std::atomic<size_t> culledPathCount{ 0 };
+  std::atomic<size_t> culledTriangleCount{ 0 };
+  std::ranges::iota_view pathIndexView{ 0, static_cast<int>(paths.GetPathCount()) };
+  std::for_each(std::execution::par,
+                pathIndexView.begin(),
+                pathIndexView.end(),
+                [&](int pathIndex)
+  {
+    const Path path{ paths.GetPath(pathIndex) };
+    const GraphicsState& graphicsState{ states[paths.GetStateIndex(pathIndex)] };
+    const std::optional<Rectangle>& clip{ graphicsState.GetClip() };
+    if (clip)
+    {
+      // Paths outside of the clip are dropped before they are tessellated
+      if (const auto bounds{ path.GetBounds(graphicsState) }; bounds && IsOutside(*bounds, *clip))
+      {
+        culledPathCount++;
+        return;
+      }
+    }
+
+    // Cannot write to the triangles of the page directly because the order of paths must be preserved
+    auto& pathTriangles{ batch.m_pathTriangles[pathIndex] };
+    pathTriangles.reserve(path.GetApproximateTriangleCount());
+    path.GetTriangles(graphicsState, pathTriangles);
+    if (clip)
+      culledTriangleCount += ClipTriangles(pathTriangles, *clip);
+  });
+  batch.m_culledPathCount = culledPathCount;
+  batch.m_culledTriangleCount = culledTriangleCount;
+  return batch;
+}
+
+void PDFTessellator::AddBatch(const PDFDisplayList& displayList, Batch&& batch)
+{
+  size_t triangleCount{ m_pageTriangles.m_triangles.size() };
+  for (const auto& pathTriangles : batch.m_pathTriangles)
+    triangleCount += pathTriangles.size();
+  // Grown geometrically, batches of small pages are added once
+  if (triangleCount > m_pageTriangles.m_triangles.capacity())
+    m_pageTriangles.m_triangles.reserve(std::max(triangleCount, m_pageTriangles.m_triangles.capacity() * 2));
+
+  // Every form is added as instances first, forms which turn out to be painted only once are merged in Finish
+  auto formPlacement{ batch.m_formPlacements.begin() };
+  for (size_t pathIndex{ 0 }; pathIndex <= batch.m_pathTriangles.size(); ++pathIndex)
+  {
+    for (; formPlacement != batch.m_formPlacements.end() && formPlacement->m_pathCount == pathIndex; ++formPlacement)
+      AddFormPlacement(displayList, *formPlacement);
+    if (pathIndex < batch.m_pathTriangles.size())
+    {
+      const auto& pathTriangles{ batch.m_pathTriangles[pathIndex] };
+      m_pageTriangles.m_triangles.insert(m_pageTriangles.m_triangles.end(), pathTriangles.begin(), pathTriangles.end());
+    }
+  }
+  m_pageTriangles.m_culledPathCount += batch.m_culledPathCount;
+  m_pageTriangles.m_culledTriangleCount += batch.m_culledTriangleCount;
+}
+
+void PDFTessellator::AddOldestBatch(const PDFDisplayList& displayList)
+{
+  Batch batch{ m_batches.front().get() };
+  m_batches.pop_front();
+  AddBatch(displayList, std::move(batch));
+}
+
+void PDFTessellator::AddFormPlacement(const PDFDisplayList& displayList,
+                                      const PDFDisplayList::FormPlacement& formPlacement)
+{
+  const auto triangles{ GetFormTriangles(displayList.GetForm(formPlacement.m_formIndex)) };
+  if (!formPlacement.m_clip)
+  {
+    AddInstance(triangles, formPlacement.m_transform);
+    return;
+  }
+
+  auto boundsIt{ m_formBounds.find(triangles.get()) };
+  if (boundsIt == m_formBounds.end())
+    boundsIt = m_formBounds.emplace(triangles.get(), GetBounds(*triangles)).first;
+  std::optional<Rectangle> bounds{ boundsIt->second };
+  if (bounds)
+    bounds = TransformRectangle(formPlacement.m_transform, *bounds);
+  const Rectangle& clip{ *formPlacement.m_clip };
+  if (bounds && IsOutside(*bounds, clip))
+  {
+    m_pageTriangles.m_culledTriangleCount += triangles->size();
+    return;
+  }
+  if (!bounds || IsInside(*bounds, clip))
+  {
+    AddInstance(triangles, formPlacement.m_transform);
+    return;
+  }
+
+  // A placement which is partly clipped is added to the triangles of the page, the instances are shared
+  std::vector<Triangle> placedTriangles;
+  placedTriangles.reserve(triangles->size());
+  for (const Triangle& triangle : *triangles)
+    placedTriangles.push_back(TransformTriangle(formPlacement.m_transform, triangle));
+  m_pageTriangles.m_culledTriangleCount += ClipTriangles(placedTriangles, clip);
+  m_pageTriangles.m_triangles.insert(m_pageTriangles.m_triangles.end(), placedTriangles.begin(), placedTriangles.end());
+}
+
+void PDFTessellator::AddInstance(const std::shared_ptr<const std::vector<Triangle>>& triangles, const CTM& transform)
+{
+  // Consecutive placements of the same form are drawn with a single call
+  auto& instances{ m_pageTriangles.m_instances };
+  const size_t triangleOffset{ m_pageTriangles.m_triangles.size() };
+  if (instances.empty() || instances.back().m_triangles != triangles ||
+      instances.back().m_triangleOffset != triangleOffset)
+    instances.push_back({ triangleOffset, triangles, {} });
+  instances.back().m_transforms.push_back(transform);
+}
+
+void PDFTessellator::AddFormsPaintedOnce()
+{
+  // A form which is painted only once is added to the triangles of the page, instancing would only cost a draw call
+  std::unordered_map<const std::vector<Triangle>*, size_t> placementCounts;
+  for (const auto& instances : m_pageTriangles.m_instances)
+    placementCounts[instances.m_triangles.get()] += instances.m_transforms.size();
+  if (std::ranges::none_of(placementCounts, [](const auto& entry) { return entry.second == 1; }))
+    return;
+
+  const PageTriangles instancedTriangles{ std::exchange(m_pageTriangles, {}) };
+  m_pageTriangles.m_culledPathCount = instancedTriangles.m_culledPathCount;
+  m_pageTriangles.m_culledTriangleCount = instancedTriangles.m_culledTriangleCount;
+  size_t triangleCount{ instancedTriangles.m_triangles.size() };
+  for (const auto& instances : instancedTriangles.m_instances)
+    if (placementCounts[instances.m_triangles.get()] == 1)
+      triangleCount += instances.m_triangles->size();
+  m_pageTriangles.m_triangles.reserve(triangleCount);
+
+  size_t triangleOffset{ 0 };
+  for (const auto& instances : instancedTriangles.m_instances)
+  {
+    m_pageTriangles.m_triangles.insert(
+      m_pageTriangles.m_triangles.end(),
+      instancedTriangles.m_triangles.begin() + static_cast<std::ptrdiff_t>(triangleOffset),
+      instancedTriangles.m_triangles.begin() + static_cast<std::ptrdiff_t>(instances.m_triangleOffset));
+    triangleOffset = instances.m_triangleOffset;
+    if (placementCounts[instances.m_triangles.get()] == 1)
+    {
+      for (const Triangle& triangle : *instances.m_triangles)
+        m_pageTriangles.m_triangles.push_back(TransformTriangle(instances.m_transforms.front(), triangle));
+      continue;
+    }
+    for (const CTM& transform : instances.m_transforms)
+      AddInstance(instances.m_triangles, transform);
+  }
+  m_pageTriangles.m_triangles.insert(m_pageTriangles.m_triangles.end(),
+                                     instancedTriangles.m_triangles.begin() +
+                                       static_cast<std::ptrdiff_t>(triangleOffset),
+                                     instancedTriangles.m_triangles.end());
+}
+
+std::shared_ptr<const std::vector<Triangle>> PDFTessellator::GetFormTriangles(const PDFDisplayList& form)
+{
+  if (auto it{ m_formTriangles->find(&form) }; it != m_formTriangles->end())
+    return it->second;
+
+  // The forms painted by the form become a part of its triangles
+  const PageTriangles formPageTriangles{ PDFTessellator{ m_formTriangles }.Finish(form) };
+  m_pageTriangles.m_culledPathCount += formPageTriangles.m_culledPathCount;
+  m_pageTriangles.m_culledTriangleCount += formPageTriangles.m_culledTriangleCount;
+  std::vector<Triangle> triangles;
+  size_t triangleOffset{ 0 };
+  for (const auto& instances : formPageTriangles.m_instances)
+  {
+    triangles.insert(triangles.end(),
+                     formPageTriangles.m_triangles.begin() + static_cast<std::ptrdiff_t>(triangleOffset),
+                     formPageTriangles.m_triangles.begin() + static_cast<std::ptrdiff_t>(instances.m_triangleOffset));
+    triangleOffset = instances.m_triangleOffset;
+    for (const CTM& transform : instances.m_transforms)
+      for (const Triangle& triangle : *instances.m_triangles)
+        triangles.push_back(TransformTriangle(transform, triangle));
+  }
+  triangles.insert(triangles.end(),
+                   formPageTriangles.m_triangles.begin() + static_cast<std::ptrdiff_t>(triangleOffset),
+                   formPageTriangles.m_triangles.end());
+
+  // Content outside of the bounding box is clipped
+  if (form.GetBoundingBox())
+    m_pageTriangles.m_culledTriangleCount += ClipTriangles(triangles, *form.GetBoundingBox());
+
+  auto sharedTriangles{ std::make_shared<const std::vector<Triangle>>(std::move(triangles)) };
+  m_formTriangles->emplace(&form, sharedTriangles);
+  return sharedTriangles;
+}
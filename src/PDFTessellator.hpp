@@ -0,0 +1,66 @@
+#pragma once
+
+#include "GraphicsState.hpp"
+#include "PDFDisplayList.hpp"
+#include "PageTriangles.hpp"
+#include "PathStore.hpp"
+#include "math/Matrix.hpp"
+#include "math/Rectangle.hpp"
+#include "math/Triangle.hpp"
+#include <cstddef>
+#include <deque>
+#include <future>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+// Tessellates the paths of a display list in batches while the display list is still recorded. The paths which were
+// painted since the last batch are replayed into a store of their own and tessellated by a worker. The triangles of the
+// batches are added to the page in painting order, and the paths are released with their batch. Only a few batches are
+// in flight, recording waits for the oldest one before it starts another, so the paths of a page are never all in
+// memory at once.
+class PDFTessellator
+{
+  static constexpr size_t BATCH_PATH_COUNT{ 4096 };
+  static constexpr size_t MAX_BATCHES_IN_FLIGHT{ 4 };
+
+  // Triangles of the forms in their own space, forms painted from several display lists are tessellated once
+  using FormTriangles = std::unordered_map<const PDFDisplayList*, std::shared_ptr<const std::vector<Triangle>>>;
+
+  struct Batch
+  {
+    std::vector<std::vector<Triangle>> m_pathTriangles;
+    std::vector<PDFDisplayList::FormPlacement> m_formPlacements; // Painted between the paths
+    size_t m_culledPathCount{ 0 };
+    size_t m_culledTriangleCount{ 0 };
+  };
+
+  std::shared_ptr<FormTriangles> m_formTriangles;
+  PDFDisplayList::ReplayPosition m_position;
+  size_t m_replayedPathCount{ 0 };
+  std::deque<std::future<Batch>> m_batches; // In flight, oldest first
+  PageTriangles m_pageTriangles;
+  // Of the triangles of the forms in their own space, for clipping their placements
+  std::unordered_map<const std::vector<Triangle>*, std::optional<Rectangle>> m_formBounds;
+
+  explicit PDFTessellator(std::shared_ptr<FormTriangles> formTriangles);
+
+  static Batch Tessellate(const PathStore& paths,
+                          const std::vector<GraphicsState>& states,
+                          std::vector<PDFDisplayList::FormPlacement>&& formPlacements);
+  void AddBatch(const PDFDisplayList& displayList, Batch&& batch);
+  void AddOldestBatch(const PDFDisplayList& displayList);
+  void AddFormPlacement(const PDFDisplayList& displayList, const PDFDisplayList::FormPlacement& formPlacement);
+  void AddInstance(const std::shared_ptr<const std::vector<Triangle>>& triangles, const CTM& transform);
+  void AddFormsPaintedOnce();
+  std::shared_ptr<const std::vector<Triangle>> GetFormTriangles(const PDFDisplayList& form);
+
+public:
+  PDFTessellator();
+
+  // Starts tessellating the paths which were painted since the last batch, once there are enough of them
+  void Update(const PDFDisplayList& displayList);
+  // Tessellates the remaining paths and returns the triangles of all paths which were painted
+  PageTriangles Finish(const PDFDisplayList& displayList);
+};
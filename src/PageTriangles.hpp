@@ -0,0 +1,25 @@
+#pragma once
+
+#include "math/Matrix.hpp"
+#include "math/Triangle.hpp"
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Triangles of a page in painting order. Forms which are painted more than once are tessellated once in their own space
+// and drawn as instances, each placement of the form only adds its transform.
+struct PageTriangles
+{
+  struct Instances
+  {
+    size_t m_triangleOffset{ 0 }; // Number of triangles of the page which are painted before the instances
+    std::shared_ptr<const std::vector<Triangle>> m_triangles;
+    std::vector<Matrix3> m_transforms;
+  };
+
+  std::vector<Triangle> m_triangles;
+  std::vector<Instances> m_instances; // Ordered by m_triangleOffset
+  // Content outside of the clip, paths which are outside as a whole are not tessellated
+  size_t m_culledPathCount{ 0 };
+  size_t m_culledTriangleCount{ 0 };
+};
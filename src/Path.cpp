@@ -1,48 +1,54 @@
 #include "Path.hpp"
 #include <CDT.h>
+#include <algorithm>
 
-Path::Path()
+Path::Path(std::span<const Vector2> points, std::span<const SubPathRange> subPaths, PathMode pathMode)
+  : m_points(points)
+  , m_subPaths(subPaths)
+  , m_pathMode(pathMode)
 {
-  m_subPaths.emplace_back();
 }
 
-void Path::AddPathMode(PathMode pathMode)
+SubPath Path::GetSubPath(const SubPathRange& subPathRange) const
 {
-  m_pathMode |= pathMode;
+  return { m_points.subspan(subPathRange.m_firstPoint, subPathRange.m_pointCount), subPathRange.m_closed };
 }
 
-void Path::AddNewSubPath()
-{
-  m_subPaths.emplace_back();
-}
-
-void Path::CloseSubPath()
-{
-  m_subPaths.back().ClosePath();
-}
-
-void Path::AddPoint(const Vector2& point)
+int Path::GetApproximateTriangleCount() const
 {
-  m_subPaths.back().AddPoint(point);
+  int approximateTriangleCount{ 0 };
+  // This approximation should be good enough for now
+  for (const SubPathRange& subPathRange : m_subPaths)
+    approximateTriangleCount += static_cast<int>(subPathRange.m_pointCount);
+  return approximateTriangleCount;
 }
 
-void Path::AddBezierCurve(const Vector2& p1, const Vector2& p2, const Vector2& p3)
+std::optional<Rectangle> Path::GetBounds(const GraphicsState& graphicsState) const
 {
-  m_subPaths.back().AddBezierCurve(p1, p2, p3);
-}
+  std::optional<Rectangle> bounds;
+  for (const SubPathRange& subPathRange : m_subPaths)
+  {
+    for (const Vector2& point : GetSubPath(subPathRange).GetPoints())
+    {
+      if (!bounds)
+        bounds = Rectangle{ point, point };
+      bounds->min = { std::min(bounds->min.x, point.x), std::min(bounds->min.y, point.y) };
+      bounds->max = { std::max(bounds->max.x, point.x), std::max(bounds->max.y, point.y) };
+    }
+  }
+  if (!bounds)
+    return std::nullopt;
 
-void Path::AddBezierCurveDuplicateStartPoint(const Vector2& p2, const Vector2& p3)
-{
-  m_subPaths.back().AddBezierCurveDuplicateStartPoint(p2, p3);
-}
+  if (EnumFlagSet(m_pathMode, PathMode::Stroke))
+  {
+    // Miters are at most as long as the miter limit of SubPath::Stroke times half the line width, caps are shorter
+    constexpr float MITER_LIMIT{ 10 };
+    const float extent{ graphicsState.GetLineWidth() / 2.f * MITER_LIMIT };
+    bounds->min -= Vector2{ extent, extent };
+    bounds->max += Vector2{ extent, extent };
+  }
 
-int Path::GetApproximateTriangleCount() const
-{
-  int approximateTriangleCount{ 0 };
-  // This approximation should be good enough for now
-  for (const auto& subPath : m_subPaths)
-    approximateTriangleCount += static_cast<int>(subPath.GetPoints().size());
-  return approximateTriangleCount;
+  return graphicsState.Transform(*bounds);
 }
 
 void Path::GetTriangles(const GraphicsState& graphicsState, std::vector<Triangle>& trianglesOut) const
@@ -51,8 +57,8 @@ void Path::GetTriangles(const GraphicsState& graphicsState, std::vector<Triangle
 
   if (EnumFlagSet(m_pathMode, PathMode::Stroke))
   {
-    for (const SubPath& subPath : m_subPaths)
-      subPath.Stroke(graphicsState, trianglesOut);
+    for (const SubPathRange& subPathRange : m_subPaths)
+      GetSubPath(subPathRange).Stroke(graphicsState, trianglesOut);
   }
   if (EnumFlagSet(m_pathMode, PathMode::Fill))
   {
@@ -60,8 +66,9 @@ void Path::GetTriangles(const GraphicsState& graphicsState, std::vector<Triangle
     Triangulator::V2dVec tVertices;
     std::vector<CDT::Edge> tEdges;
 
-    for (const SubPath& subPath : m_subPaths)
+    for (const SubPathRange& subPathRange : m_subPaths)
     {
+      const SubPath subPath{ GetSubPath(subPathRange) };
       if (subPath.IsEmpty())
         continue;
 
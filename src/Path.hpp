@@ -3,8 +3,12 @@
 #include "GraphicsState.hpp"
 #include "SubPath.hpp"
 #include "math/EnumFlagOperators.hpp"
+#include "math/Rectangle.hpp"
 #include "math/Triangle.hpp"
 #include "math/Vector.hpp"
+#include <cstdint>
+#include <optional>
+#include <span>
 #include <vector>
 
 enum class PathMode : unsigned
@@ -15,20 +19,31 @@ enum class PathMode : unsigned
 };
 DEFINE_ENUM_FLAGS(PathMode, unsigned)
 
+// A path in a PathStore, a view of its subpaths
 class Path
 {
-  std::vector<SubPath> m_subPaths;
+public:
+  // Points of a subpath in the points of the store
+  struct SubPathRange
+  {
+    uint32_t m_firstPoint{ 0 };
+    uint32_t m_pointCount{ 0 };
+    bool m_closed{ false };
+  };
+
+private:
+  std::span<const Vector2> m_points; // Of the whole store
+  std::span<const SubPathRange> m_subPaths;
   PathMode m_pathMode{ PathMode::None };
 
+  SubPath GetSubPath(const SubPathRange& subPathRange) const;
+
 public:
-  Path();
+  Path(std::span<const Vector2> points, std::span<const SubPathRange> subPaths, PathMode pathMode);
 
-  void AddPathMode(PathMode pathMode);
-  void AddNewSubPath();
-  void CloseSubPath();
-  void AddPoint(const Vector2& point);
-  void AddBezierCurve(const Vector2& p1, const Vector2& p2, const Vector2& p3);
-  void AddBezierCurveDuplicateStartPoint(const Vector2& p2, const Vector2& p3);
   int GetApproximateTriangleCount() const;
+  // Bounds of the triangles in the space of the page, strokes are included with their longest miters. Empty if the path
+  // has no points.
+  std::optional<Rectangle> GetBounds(const GraphicsState& graphicsState) const;
   void GetTriangles(const GraphicsState& graphicsState, std::vector<Triangle>& trianglesOut) const;
 };
@@ -0,0 +1,112 @@
+#include "PathStore.hpp"
+#include <cmath>
+
+PathStore::PathStore()
+{
+  m_subPaths.emplace_back();
+}
+
+std::span<const Vector2> PathStore::GetCurrentPoints() const
+{
+  const Path::SubPathRange& subPath{ m_subPaths.back() };
+  return std::span{ m_points }.subspan(subPath.m_firstPoint, subPath.m_pointCount);
+}
+
+void PathStore::Reserve(size_t pathCount, size_t subPathCount, size_t pointCount)
+{
+  m_paths.reserve(pathCount);
+  m_subPaths.reserve(subPathCount);
+  m_points.reserve(pointCount);
+}
+
+void PathStore::Clear()
+{
+  m_points.clear();
+  m_subPaths.clear();
+  m_paths.clear();
+  m_subPaths.emplace_back();
+  m_currentPathFirstSubPath = 0;
+}
+
+void PathStore::AddNewSubPath()
+{
+  m_subPaths.push_back({ static_cast<uint32_t>(m_points.size()), 0, false });
+}
+
+void PathStore::CloseSubPath()
+{
+  // Some PDF generators (eg. LibreOffice Writer) add the first vertex two times to the end of the subpath instead of
+  // just closing the subpath
+  Path::SubPathRange& subPath{ m_subPaths.back() };
+  while (subPath.m_pointCount >= 2 && m_points[subPath.m_firstPoint] == m_points.back())
+  {
+    m_points.pop_back();
+    subPath.m_pointCount--;
+  }
+  subPath.m_closed = true;
+}
+
+void PathStore::AddPoint(const Vector2& point)
+{
+  m_points.push_back(point);
+  m_subPaths.back().m_pointCount++;
+}
+
+void PathStore::AddBezierCurve(const Vector2& p1, const Vector2& p2, const Vector2& p3)
+{
+  // TODO: Make the number of steps dependent on distance/curvature
+  int numSteps{ 5 };
+
+  if (m_subPaths.back().m_pointCount == 0) // TODO: Why can his happen?
+    AddPoint(p1);
+
+  Vector2 p0{ m_points.back() };
+
+  // Start with i=1 to not repeat the point p0
+  for (int i{ 1 }; i <= numSteps; i++)
+  {
+    float t{ static_cast<float>(i) / numSteps };
+    Vector2 p{ std::pow(1.f - t, 3.f) * p0 + 3.f * t * std::pow(1.f - t, 2.f) * p1 + 3.f * t * t * (1.f - t) * p2 +
+               std::pow(t, 3.f) * p3 };
+    AddPoint(p);
+  }
+}
+
+void PathStore::AddBezierCurveDuplicateStartPoint(const Vector2& p2, const Vector2& p3)
+{
+  // Without a current point the curve starts at its control point
+  const std::span<const Vector2> points{ GetCurrentPoints() };
+  AddBezierCurve(points.empty() ? p2 : points.back(), p2, p3);
+}
+
+void PathStore::PaintPath(PathMode pathMode, GraphicsStateTable::Index stateIndex)
+{
+  m_paths.push_back({ static_cast<uint32_t>(m_currentPathFirstSubPath),
+                      static_cast<uint32_t>(m_subPaths.size() - m_currentPathFirstSubPath),
+                      pathMode,
+                      stateIndex });
+  m_currentPathFirstSubPath = m_subPaths.size();
+  AddNewSubPath();
+}
+
+size_t PathStore::GetPathCount() const
+{
+  return m_paths.size();
+}
+
+Path PathStore::GetPath(size_t pathIndex) const
+{
+  const PathRange& path{ m_paths[pathIndex] };
+  return { m_points, std::span{ m_subPaths }.subspan(path.m_firstSubPath, path.m_subPathCount), path.m_pathMode };
+}
+
+GraphicsStateTable::Index PathStore::GetStateIndex(size_t pathIndex) const
+{
+  return m_paths[pathIndex].m_stateIndex;
+}
+
+size_t PathStore::GetByteSize() const
+{
+  return m_points.size() * sizeof(Vector2) + m_subPaths.size() * sizeof(Path::SubPathRange) +
+         m_paths.size() * sizeof(PathRange);
+}
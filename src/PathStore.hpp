@@ -0,0 +1,51 @@
+#pragma once
+
+#include "GraphicsStateTable.hpp"
+#include "Path.hpp"
+#include "math/Vector.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// The paths of a page in flat arrays: the points of all subpaths are contiguous, a subpath is a range of points and a
+// path is a range of subpaths. Building the paths of a page only grows three arrays, which are reserved up front when
+// the sizes are known. Clear keeps the memory, so a store which is reused for the next page does not allocate again.
+class PathStore
+{
+  struct PathRange
+  {
+    uint32_t m_firstSubPath{ 0 };
+    uint32_t m_subPathCount{ 0 };
+    PathMode m_pathMode{ PathMode::None };
+    GraphicsStateTable::Index m_stateIndex{ 0 };
+  };
+
+  std::vector<Vector2> m_points;
+  std::vector<Path::SubPathRange> m_subPaths;
+  std::vector<PathRange> m_paths;
+  size_t m_currentPathFirstSubPath{ 0 }; // The subpaths from it on belong to the path which is being built
+
+  std::span<const Vector2> GetCurrentPoints() const;
+
+public:
+  // Starts the first path
+  PathStore();
+
+  void Reserve(size_t pathCount, size_t subPathCount, size_t pointCount);
+  void Clear();
+
+  // Building the current path, which starts with an empty subpath
+  void AddNewSubPath();
+  void CloseSubPath();
+  void AddPoint(const Vector2& point);
+  void AddBezierCurve(const Vector2& p1, const Vector2& p2, const Vector2& p3);
+  void AddBezierCurveDuplicateStartPoint(const Vector2& p2, const Vector2& p3);
+  // Ends the current path as a painted one and starts the next path
+  void PaintPath(PathMode pathMode, GraphicsStateTable::Index stateIndex);
+
+  // The painted paths
+  size_t GetPathCount() const;
+  Path GetPath(size_t pathIndex) const;
+  GraphicsStateTable::Index GetStateIndex(size_t pathIndex) const;
+  size_t GetByteSize() const;
+};
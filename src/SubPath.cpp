@@ -1,44 +1,10 @@
 #include "SubPath.hpp"
 #include "math/Numbers.hpp"
 
-void SubPath::AddPoint(const Vector2& point)
+SubPath::SubPath(std::span<const Vector2> points, bool closed)
+  : m_points(points)
+  , m_closed(closed)
 {
-  m_points.push_back(point);
-}
-
-void SubPath::AddBezierCurve(const Vector2& p1, const Vector2& p2, const Vector2& p3)
-{
-  // TODO: Make the number of steps dependent on distance/curvature
-  int numSteps{ 5 };
-
-  if (m_points.empty()) // TODO: Why can his happen?
-    m_points.push_back(p1);
-
-  Vector2 p0{ m_points.back() };
-
-  // Start with i=1 to not repeat the point p0
-  for (int i{ 1 }; i <= numSteps; i++)
-  {
-    float t{ static_cast<float>(i) / numSteps };
-    Vector2 p{ std::pow(1.f - t, 3.f) * p0 + 3.f * t * std::pow(1.f - t, 2.f) * p1 + 3.f * t * t * (1.f - t) * p2 +
-               std::pow(t, 3.f) * p3 };
-    m_points.push_back(p);
-  }
-}
-
-void SubPath::AddBezierCurveDuplicateStartPoint(const Vector2& p2, const Vector2& p3)
-{
-  Vector2 p1{ m_points.back() };
-  AddBezierCurve(p1, p2, p3);
-}
-
-void SubPath::ClosePath()
-{
-  // Some PDF generators (eg. LibreOffice Writer) add the first vertex two times to the end of the subpath instead of
-  // just closing the subpath
-  while (m_points.size() >= 2 && m_points.front() == m_points.back())
-    m_points.pop_back();
-  m_closed = true;
 }
 
 void SubPath::DrawPie(const Vector2& center,
@@ -64,6 +30,9 @@ void SubPath::DrawPie(const Vector2& center,
 
 void SubPath::Stroke(const GraphicsState& graphicsState, std::vector<Triangle>& trianglesOut) const
 {
+  if (m_points.empty())
+    return;
+
   //     miterLength = 1 / sin(phi / 2)
   // <=>         phi = asin(1 / miterLength) * 2
   constexpr float miterLimit{ 10 };
@@ -196,7 +165,7 @@ bool SubPath::IsClosed() const
   return m_closed;
 }
 
-const std::vector<Vector2>& SubPath::GetPoints() const
+std::span<const Vector2> SubPath::GetPoints() const
 {
   return m_points;
 }
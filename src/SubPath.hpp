@@ -3,11 +3,13 @@
 #include "GraphicsState.hpp"
 #include "math/Triangle.hpp"
 #include "math/Vector.hpp"
+#include <span>
 #include <vector>
 
+// A subpath of a path in a PathStore, a view of its points
 class SubPath
 {
-  std::vector<Vector2> m_points;
+  std::span<const Vector2> m_points;
   bool m_closed{ false };
 
   void DrawPie(const Vector2& center,
@@ -18,13 +20,11 @@ class SubPath
                std::vector<Triangle>& out) const;
 
 public:
+  SubPath(std::span<const Vector2> points, bool closed);
+
   void Stroke(const GraphicsState& graphicsState, std::vector<Triangle>& trianglesOut) const;
-  void AddPoint(const Vector2& point);
-  void AddBezierCurve(const Vector2& p1, const Vector2& p2, const Vector2& p3);
-  void AddBezierCurveDuplicateStartPoint(const Vector2& p2, const Vector2& p3);
-  void ClosePath();
 
   bool IsEmpty() const;
   bool IsClosed() const;
-  const std::vector<Vector2>& GetPoints() const;
+  std::span<const Vector2> GetPoints() const;
 };
@@ -1,13 +1,76 @@
 #include "Window.hpp"
 #include "OpenGL/Renderer.hpp"
+#include "PDFDisplayListCache.hpp"
+#include "PDFDocument.hpp"
 #include "PDFStreamFinder.hpp"
 #include "PDFStreamReader.hpp"
 #include <GLFW/glfw3.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <execution>
 #include <iostream>
+#include <iterator>
+#include <ranges>
+#include <span>
 #include <thread>
+#include <unordered_map>
+#include <unordered_set>
 
 using namespace MouseEvents;
 
+namespace
+{
+void SetPageTriangles(gl::Renderer& renderer, PDFObject::ID pageId, PageTriangles&& pageTriangles)
+{
+  if (pageTriangles.m_culledPathCount > 0 || pageTriangles.m_culledTriangleCount > 0)
+  {
+    std::cerr << "Page " << pageId << ": clipping culled " << pageTriangles.m_culledPathCount << " paths and "
+              << pageTriangles.m_culledTriangleCount << " triangles\n";
+  }
+  renderer.SetPageTriangles(pageId, std::move(pageTriangles));
+}
+
+// Interprets and tessellates every page as an independent task with its own reader. Returns the display lists of the
+// pages in the order of the streams.
+std::vector<PDFDisplayListCache::Page> RenderPages(const std::vector<PDFStreamFinder::GraphicsStream>& graphicStreams,
+                                                   gl::Renderer& renderer)
+{
+  std::vector<PDFDisplayListCache::Page> pages(graphicStreams.size());
+  std::ranges::iota_view pageIndexView{ size_t{ 0 }, graphicStreams.size() };
+  std::for_each(std::execution::par,
+                pageIndexView.begin(),
+                pageIndexView.end(),
+                [&](size_t pageIndex)
+  {
+    const PDFStreamFinder::GraphicsStream& stream{ graphicStreams[pageIndex] };
+    PDFStreamReader reader;
+    reader.Read(stream);
+    SetPageTriangles(renderer, stream.m_pageId, reader.CollectTriangles());
+    pages[pageIndex] = { stream.m_pageId, stream.m_drawArea, reader.GetDisplayList(), stream.m_objectIds };
+  });
+  return pages;
+}
+
+// Tessellates pages from display lists, the content streams are not read
+void RenderPages(std::span<const PDFDisplayListCache::Page> pages, gl::Renderer& renderer)
+{
+  std::for_each(std::execution::par,
+                pages.begin(),
+                pages.end(),
+                [&](const PDFDisplayListCache::Page& page)
+  { SetPageTriangles(renderer, page.m_pageId, page.m_displayList.CollectTriangles()); });
+}
+
+uintmax_t GetFileSize(const std::filesystem::path& path)
+{
+  std::error_code error;
+  uintmax_t fileSize{ std::filesystem::file_size(path, error) };
+  return error ? 0 : fileSize;
+}
+} // namespace
+
 Window* Window::m_self{ nullptr };
 
 Window::Window()
@@ -17,7 +80,7 @@ Window::Window()
   m_self = this;
 }
 
-void Window::Run(const std::filesystem::path& sourceFile)
+void Window::Run(const std::filesystem::path& sourceFile, std::optional<size_t> pageIndex)
 {
   glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
   glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
@@ -32,17 +95,95 @@ void Window::Run(const std::filesystem::path& sourceFile)
   auto rendererPtr{ std::make_unique<gl::Renderer>(*this, dpi) };
   auto& renderer{ *rendererPtr };
 
+  std::atomic<bool> running{ true };
   std::thread loadThread{ [&]()
   {
-    auto graphicStreams{ PDFStreamFinder{}.GetGraphicsStreams(sourceFile) };
-    PDFStreamReader reader;
-    for (const auto& stream : graphicStreams)
+    // Only the objects reachable from the page tree are parsed
+    PDFDocument document;
+    document.Load(sourceFile, PDFDocument::LoadMode::Lazy);
+
+    // The first page is shown before the others are interpreted, so it appears as fast for large documents as for
+    // small ones
+    PDFStreamFinder streamFinder;
+    auto FindGraphicsStreams{ [&]()
+    {
+      return pageIndex ? streamFinder.GetGraphicsStreams(document, *pageIndex, 1)
+                       : streamFinder.GetGraphicsStreams(document);
+    } };
+
+    // The objects each shown page was built from, an update only has to render the pages which use one of its objects
+    std::unordered_map<PDFObject::ID, std::vector<PDFObject::ID>> pageObjectIds;
+    auto KeepObjectIds{ [&](const std::vector<PDFDisplayListCache::Page>& pages)
+    {
+      for (const PDFDisplayListCache::Page& page : pages)
+        pageObjectIds[page.m_pageId] = page.m_objectIds;
+    } };
+
+    // A document which was opened before is replayed from its display lists without reading the content streams
+    PDFDisplayListCache displayListCache{ sourceFile };
+    std::vector<PDFDisplayListCache::Page> cachedPages;
+    if (!pageIndex && displayListCache.Load(cachedPages) && !cachedPages.empty())
+    {
+      renderer.SetDrawArea(cachedPages.front().m_drawArea);
+      RenderPages(std::span{ cachedPages }.first(1), renderer);
+      renderer.Finish();
+      RenderPages(std::span{ cachedPages }.subspan(1), renderer);
+      KeepObjectIds(cachedPages);
+    }
+    else
     {
-      reader.Read(stream);
+      auto firstGraphicsStreams{ streamFinder.GetGraphicsStreams(document, pageIndex.value_or(0), 1) };
+      if (!firstGraphicsStreams.empty())
+        renderer.SetDrawArea(firstGraphicsStreams.front().m_drawArea);
+      auto pages{ RenderPages(firstGraphicsStreams, renderer) };
+      renderer.Finish();
+      if (!pageIndex)
+      {
+        auto otherPages{ RenderPages(streamFinder.GetGraphicsStreams(document, 1, SIZE_MAX), renderer) };
+        pages.insert(
+          pages.end(), std::make_move_iterator(otherPages.begin()), std::make_move_iterator(otherPages.end()));
+        displayListCache.Save(pages);
+      }
+      KeepObjectIds(pages);
+    }
+
+    // Tools which annotate the file append incremental updates, only the pages with changed objects are rendered again
+    uintmax_t fileSize{ GetFileSize(sourceFile) };
+    while (running)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds{ 250 });
+      uintmax_t newFileSize{ GetFileSize(sourceFile) };
+      if (newFileSize == fileSize)
+        continue;
+      fileSize = newFileSize;
+
+      std::vector<PDFObject::ID> changedObjectIds;
+      if (document.Reload(changedObjectIds))
+      {
+        // When the whole document is shown, changed objects which are pages themselves are rendered too, this includes
+        // the pages which were added by the update
+        const std::unordered_set<PDFObject::ID> changedObjects{ changedObjectIds.begin(), changedObjectIds.end() };
+        std::vector<PDFObject::ID> changedPageIds;
+        if (!pageIndex)
+          changedPageIds = changedObjectIds;
+        for (const auto& [pageId, objectIds] : pageObjectIds)
+        {
+          if (std::ranges::any_of(objectIds, [&](PDFObject::ID objectId) { return changedObjects.contains(objectId); }))
+            changedPageIds.push_back(pageId);
+        }
+        if (!changedPageIds.empty())
+          KeepObjectIds(RenderPages(streamFinder.GetGraphicsStreams(document, changedPageIds), renderer));
+      }
+      else if (document.Load(sourceFile, PDFDocument::LoadMode::Lazy))
+      {
+        auto graphicsStreams{ FindGraphicsStreams() };
+        renderer.ClearPages();
+        if (!graphicsStreams.empty())
+          renderer.SetDrawArea(graphicsStreams.front().m_drawArea);
+        pageObjectIds.clear();
+        KeepObjectIds(RenderPages(graphicsStreams, renderer));
+      }
     }
-    renderer.AddTriangles(reader.CollectTriangles());
-    renderer.SetDrawArea(reader.GetDrawArea());
-    renderer.Finish();
   } };
 
   glfwSetCursorPosCallback(window, &Window::CursorPositionCallback_impl);
@@ -65,11 +206,12 @@ void Window::Run(const std::filesystem::path& sourceFile)
     glfwPollEvents();
     glfwSwapBuffers(window);
   }
+  running = false;
+  loadThread.join();
+
   rendererPtr.reset(); // Do OpenGL cleanup before the window is destroyed
   glfwDestroyWindow(window);
   glfwTerminate();
-
-  loadThread.join();
 }
 
 void Window::SetMouseMoveCallback(const MouseMoveCallback& callback)
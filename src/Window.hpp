@@ -3,6 +3,7 @@
 #include "MouseEvents.hpp"
 #include "math/Vector.hpp"
 #include <filesystem>
+#include <optional>
 
 class GLFWwindow;
 
@@ -21,7 +22,8 @@ class Window
 
 public:
   Window();
-  void Run(const std::filesystem::path& sourceFile);
+  // Shows only the page with the given index if there is one, otherwise all pages
+  void Run(const std::filesystem::path& sourceFile, std::optional<size_t> pageIndex = {});
 
   void SetMouseMoveCallback(const MouseEvents::MouseMoveCallback& callback);
   void SetMouseButtonCallback(const MouseEvents::MouseButtonCallback& callback);
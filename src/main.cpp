@@ -1,11 +1,31 @@
 #include "Window.hpp"
+#include <charconv>
+#include <iostream>
+#include <optional>
+#include <string_view>
 
 int main(int argc, char** argv)
 {
-  if (argc >= 1)
+  std::optional<size_t> pageIndex;
+  for (int i{ 2 }; i < argc; i += 2)
+  {
+    std::string_view argument{ argv[i] };
+    std::string_view value{ i + 1 < argc ? argv[i + 1] : "" };
+    size_t pageNumber{ 0 };
+    if (argument != "--page" ||
+        std::from_chars(value.data(), value.data() + value.size(), pageNumber).ptr != value.data() + value.size() ||
+        pageNumber == 0)
+    {
+      std::cerr << "Usage: " << argv[0] << " <file> [--page <number>]\n";
+      return 1;
+    }
+    pageIndex = pageNumber - 1;
+  }
+
+  if (argc >= 2)
   {
     Window window;
-    window.Run(argv[1]);
+    window.Run(argv[1], pageIndex);
   }
 
   return 0;
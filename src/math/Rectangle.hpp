@@ -8,6 +8,8 @@ public:
   Vector2 min;
   Vector2 max;
 
+  bool operator==(const Rectangle& other) const = default;
+
   float Width() const { return max.x - min.x; }
   float Height() const { return max.y - min.y; }
   Vector2 Size() const { return { max - min }; }